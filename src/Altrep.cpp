@@ -0,0 +1,211 @@
+#include "Columnar.h"
+#include <R_ext/Altrep.h>
+
+/*
+ * ALTREP classes used to expose column stores to R.
+ *
+ * data1: external pointer to a column_ref
+ * data2: the materialized R vector (R_NilValue until DATAPTR is requested),
+ *        once set it is the only source of the values (R may have written in it)
+ *
+ * Text cells are converted to CHARSXP one at a time by Elt, numeric columns
+ * of a sealed store with no row selection share the store memory.
+ */
+
+static R_altrep_class_t columnar_string_class;
+static R_altrep_class_t columnar_real_class;
+static R_altrep_class_t columnar_integer_class;
+
+
+//' Get the column referenced by an ALTREP vector
+static column_ref* get_ref(SEXP x){
+  return static_cast<column_ref*>(R_ExternalPtrAddr(R_altrep_data1(x)));
+}
+
+static void finalize_ref(SEXP ptr){
+  column_ref* ref = static_cast<column_ref*>(R_ExternalPtrAddr(ptr));
+  if(ref != NULL){
+    delete(ref);
+    R_ClearExternalPtr(ptr);
+  }
+}
+
+
+//' Create an ALTREP vector for a column of a view
+//'
+//' @param view source view
+//' @param col column of the store (-1 for db_index)
+//'
+//' @return an ALTREP character, numeric or integer vector
+SEXP make_altrep_column(column_view& view, int col){
+  column_ref* ref = new column_ref();
+  ref->view = view;
+  ref->col = col;
+  SEXP ptr = PROTECT(R_MakeExternalPtr(ref, R_NilValue, R_NilValue));
+  R_RegisterCFinalizerEx(ptr, finalize_ref, TRUE);
+
+  SEXP out;
+  if(col == -1){
+    out = R_new_altrep(columnar_integer_class, ptr, R_NilValue);
+  }else if(view.store->is_numeric(col)){
+    out = R_new_altrep(columnar_real_class, ptr, R_NilValue);
+  }else{
+    out = R_new_altrep(columnar_string_class, ptr, R_NilValue);
+  }
+  UNPROTECT(1);
+  return out;
+}
+
+
+/* --- common methods --- */
+
+static R_xlen_t columnar_length(SEXP x){
+  return get_ref(x)->view.nrow();
+}
+
+static Rboolean columnar_inspect(SEXP x, int pre, int deep, int pvec,
+                                 void (*inspect_subtree)(SEXP, int, int, int)){
+  column_ref* ref = get_ref(x);
+  Rprintf("columnar %s (len=%d, materialized=%s)\n",
+          ref->col == -1 ? "db_index" : ref->view.store->header[ref->col].c_str(),
+          ref->view.nrow(),
+          R_altrep_data2(x) == R_NilValue ? "F" : "T");
+  return TRUE;
+}
+
+static const void* columnar_dataptr_or_null(SEXP x){
+  SEXP data2 = R_altrep_data2(x);
+  if(data2 == R_NilValue){
+    return NULL;
+  }
+  return DATAPTR(data2);
+}
+
+
+/* --- character columns --- */
+
+static SEXP columnar_string_elt(SEXP x, R_xlen_t i){
+  SEXP data2 = R_altrep_data2(x);
+  if(data2 != R_NilValue){
+    return STRING_ELT(data2, i);
+  }
+  column_ref* ref = get_ref(x);
+  int row = ref->view.row(i);
+  int length = ref->view.store->text_length(row, ref->col);
+  if(length == 0){
+    return NA_STRING;
+  }
+  return Rf_mkCharLenCE(ref->view.store->text_at(row, ref->col), length, CE_UTF8);
+}
+
+static void* columnar_string_dataptr(SEXP x, Rboolean writeable){
+  SEXP data2 = R_altrep_data2(x);
+  if(data2 == R_NilValue){
+    R_xlen_t n = columnar_length(x);
+    data2 = PROTECT(Rf_allocVector(STRSXP, n));
+    for(R_xlen_t i = 0; i<n; i++){
+      SET_STRING_ELT(data2, i, columnar_string_elt(x, i));
+    }
+    R_set_altrep_data2(x, data2);
+    UNPROTECT(1);
+  }
+  return DATAPTR(data2);
+}
+
+static void columnar_string_set_elt(SEXP x, R_xlen_t i, SEXP value){
+  columnar_string_dataptr(x, TRUE); // materialized, as for a writeable DATAPTR
+  SET_STRING_ELT(R_altrep_data2(x), i, value);
+}
+
+
+/* --- numeric columns --- */
+
+static double columnar_real_elt(SEXP x, R_xlen_t i){
+  SEXP data2 = R_altrep_data2(x);
+  if(data2 != R_NilValue){
+    return REAL(data2)[i];
+  }
+  column_ref* ref = get_ref(x);
+  return ref->view.store->number_at(ref->view.row(i), ref->col);
+}
+
+static void* columnar_real_dataptr(SEXP x, Rboolean writeable){
+  SEXP data2 = R_altrep_data2(x);
+  if(data2 != R_NilValue){
+    return DATAPTR(data2);
+  }
+  column_ref* ref = get_ref(x);
+  if(!writeable && !ref->view.rows && ref->view.store->is_sealed()){
+    return ref->view.store->numbers_of(ref->col); // no copy
+  }
+  R_xlen_t n = columnar_length(x);
+  data2 = PROTECT(Rf_allocVector(REALSXP, n));
+  for(R_xlen_t i = 0; i<n; i++){
+    REAL(data2)[i] = columnar_real_elt(x, i);
+  }
+  R_set_altrep_data2(x, data2);
+  UNPROTECT(1);
+  return DATAPTR(data2);
+}
+
+
+/* --- db_index column --- */
+
+static int columnar_integer_elt(SEXP x, R_xlen_t i){
+  SEXP data2 = R_altrep_data2(x);
+  if(data2 != R_NilValue){
+    return INTEGER(data2)[i];
+  }
+  column_ref* ref = get_ref(x);
+  return ref->view.store->db_index[ref->view.row(i)];
+}
+
+static void* columnar_integer_dataptr(SEXP x, Rboolean writeable){
+  SEXP data2 = R_altrep_data2(x);
+  if(data2 != R_NilValue){
+    return DATAPTR(data2);
+  }
+  column_ref* ref = get_ref(x);
+  if(!writeable && !ref->view.rows && ref->view.store->is_sealed()){
+    return ref->view.store->db_index.data(); // no copy
+  }
+  R_xlen_t n = columnar_length(x);
+  data2 = PROTECT(Rf_allocVector(INTSXP, n));
+  for(R_xlen_t i = 0; i<n; i++){
+    INTEGER(data2)[i] = columnar_integer_elt(x, i);
+  }
+  R_set_altrep_data2(x, data2);
+  UNPROTECT(1);
+  return DATAPTR(data2);
+}
+
+
+//' Register the ALTREP classes
+//'
+//' called when the package is loaded
+//'
+//' @param dll package dll info
+// [[Rcpp::init]]
+void init_columnar_altrep(DllInfo* dll){
+  columnar_string_class = R_make_altstring_class("columnar_string", "rMAFdb", dll);
+  R_set_altrep_Length_method(columnar_string_class, columnar_length);
+  R_set_altrep_Inspect_method(columnar_string_class, columnar_inspect);
+  R_set_altvec_Dataptr_method(columnar_string_class, columnar_string_dataptr);
+  R_set_altvec_Dataptr_or_null_method(columnar_string_class, columnar_dataptr_or_null);
+  R_set_altstring_Elt_method(columnar_string_class, columnar_string_elt);
+  R_set_altstring_Set_elt_method(columnar_string_class, columnar_string_set_elt);
+
+  columnar_real_class = R_make_altreal_class("columnar_real", "rMAFdb", dll);
+  R_set_altrep_Length_method(columnar_real_class, columnar_length);
+  R_set_altrep_Inspect_method(columnar_real_class, columnar_inspect);
+  R_set_altvec_Dataptr_method(columnar_real_class, columnar_real_dataptr);
+  R_set_altvec_Dataptr_or_null_method(columnar_real_class, columnar_dataptr_or_null);
+  R_set_altreal_Elt_method(columnar_real_class, columnar_real_elt);
+
+  columnar_integer_class = R_make_altinteger_class("columnar_integer", "rMAFdb", dll);
+  R_set_altrep_Length_method(columnar_integer_class, columnar_length);
+  R_set_altrep_Inspect_method(columnar_integer_class, columnar_inspect);
+  R_set_altvec_Dataptr_method(columnar_integer_class, columnar_integer_dataptr);
+  R_set_altvec_Dataptr_or_null_method(columnar_integer_class, columnar_dataptr_or_null);
+  R_set_altinteger_Elt_method(columnar_integer_class, columnar_integer_elt);
+}
@@ -0,0 +1,274 @@
+#include "AsyncLoader.h"
+
+/* results of async_loader::take */
+const int CHUNK_READY = 0;
+const int CHUNK_PENDING = 1;
+const int CHUNKS_DONE = 2;
+
+
+//' Asynchronous loader constructor
+//'
+//' Opens the file, skips comments and header and starts the worker thread.
+//'
+//' @param path path to the MAF file
+//' @param options structure of the MAF and loading options
+//' @param max_chunk maximum number of lines of a chunk
+//' @param limit maximum number of lines to be read (negative for no limit)
+//' @param queue_size maximum number of prepared chunks waiting for R
+async_loader::async_loader(std::string path, reader_options options, int max_chunk, double limit, int queue_size)
+  : loader(options){
+  this->in.open(path, std::ios::binary);
+  if(!this->in.good()){
+    stop("ERROR: cannot open " + path);
+  }
+  this->max_chunk = std::max(max_chunk, 1);
+  this->limit = limit;
+  this->queue_size = std::max(queue_size, 1);
+  this->line_number = 0;
+  this->finished = false;
+  this->stopped = false;
+
+  // skip comments and header (same logic of maf_db_loader)
+  std::string line;
+  while(std::getline(this->in, line)){
+    if(line != "" && line[0] != '#') break;
+  }
+
+  this->worker = std::thread(&async_loader::work, this);
+}
+
+
+//' Destructor
+//'
+//' stops and joins the worker thread
+async_loader::~async_loader(){
+  this->close();
+}
+
+
+//' Read the next lines of the file
+//'
+//' @param lines output (the strings are reused to keep their memory)
+//'
+//' @return false if there is nothing left to read
+bool async_loader::read_lines(std::vector<std::string>& lines){
+  int n = this->max_chunk;
+  if(this->limit >= 0){
+    n = std::min((double) n, this->limit - this->line_number);
+  }
+  int n_read = 0;
+  while(n_read < n){
+    if(lines.size() <= n_read) lines.emplace_back();
+    std::string& line = lines[n_read];
+    if(!std::getline(this->in, line)) break;
+    if(line.size() > 0 && line.back() == '\r') line.pop_back(); // as readLines
+    n_read++;
+  }
+  lines.resize(n_read);
+  return n_read > 0;
+}
+
+
+//' Worker thread
+//'
+//' reads, parses and serializes chunks until the end of the file
+//' (or of the limit), waits when the queue is full. Errors are stored
+//' with their message and raised by take (R cannot be called from here).
+void async_loader::work(){
+  std::vector<std::string> lines;
+  try{
+    while(true){
+      {
+        std::unique_lock<std::mutex> guard(this->lock);
+        this->not_full.wait(guard, [this]{return this->stopped || this->queue.size() < this->queue_size;});
+        if(this->stopped) break;
+      }
+      if(!this->read_lines(lines)) break;
+
+      prepared_chunk chunk;
+      chunk.starting_point = this->line_number;
+      chunk.lines = lines.size();
+      chunk.queries = this->loader.read(lines, this->line_number);
+      chunk.partitions = this->loader.partitions;
+      this->line_number += lines.size();
+
+      std::lock_guard<std::mutex> guard(this->lock);
+      this->queue.push_back(std::move(chunk));
+      this->not_empty.notify_one();
+    }
+  }catch(std::exception& e){
+    std::lock_guard<std::mutex> guard(this->lock);
+    this->error = e.what();
+  }catch(...){
+    std::lock_guard<std::mutex> guard(this->lock);
+    this->error = "cannot parse chunk starting at line " + std::to_string(this->line_number + 1);
+  }
+  std::lock_guard<std::mutex> guard(this->lock);
+  this->finished = true;
+  this->not_empty.notify_all();
+}
+
+
+//' Take the next prepared chunk
+//'
+//' Errors of the worker are raised here (on the R thread), after the chunks
+//' prepared before the error.
+//'
+//' @param out the chunk (when ready)
+//' @param wait if true, wait until a chunk is ready or the file is over
+//'
+//' @return CHUNK_READY, CHUNK_PENDING (only if not waiting) or CHUNKS_DONE
+int async_loader::take(prepared_chunk& out, bool wait){
+  std::unique_lock<std::mutex> guard(this->lock);
+  while(wait && this->queue.empty() && !this->finished){
+    // wake up regularly to let the user interrupt R
+    this->not_empty.wait_for(guard, std::chrono::milliseconds(100));
+    guard.unlock();
+    checkUserInterrupt();
+    guard.lock();
+  }
+  if(!this->queue.empty()){
+    out = std::move(this->queue.front());
+    this->queue.pop_front();
+    this->not_full.notify_one();
+    return CHUNK_READY;
+  }
+  if(this->finished && this->error != ""){
+    std::string message = this->error;
+    guard.unlock();
+    stop("ERROR: " + message);
+  }
+  return this->finished ? CHUNKS_DONE : CHUNK_PENDING;
+}
+
+
+//' Stop the worker thread
+//'
+//' pending chunks are discarded
+void async_loader::close(){
+  {
+    std::lock_guard<std::mutex> guard(this->lock);
+    this->stopped = true;
+    this->queue.clear();
+    this->not_full.notify_all();
+  }
+  if(this->worker.joinable()){
+    this->worker.join();
+  }
+  if(this->in.is_open()){
+    this->in.close();
+  }
+}
+
+
+//' Summary tables
+//'
+//' stops the worker thread, so that the counts are not updated anymore
+//'
+//' @return creation and insertion queries of the summary tables
+std::vector<std::string> async_loader::summaries(){
+  this->close();
+  return this->loader.summaries();
+}
+
+
+//' Start an asynchronous MAF loader
+//'
+//' A background thread reads, parses and serializes the next chunks of the
+//' file while R sends the current one to the database.
+//'
+//' @param path path to the MAF file
+//' @param table_name name of the db table
+//' @param header names of the columns
+//' @param rules list of actions to manage fields (see maf_db_reader)
+//' @param types types of the columns ("" if unknown, see maf_loader_create)
+//' @param vcf_info_keys keys of the wide vcf_info table (empty for a key/value table)
+//' @param vcf_info_types types of the keys
+//' @param dialect SQL dialect of the queries (postgresql, sqlite or duckdb)
+//' @param partition_by name of the partition column (empty for no partitions)
+//' @param partitions values of the existing partitions
+//' @param partition_buckets number of partitions (the values are hashed, see maf_partition_buckets)
+//' @param summaries if TRUE, count genes per sample, classifications, impacts and filters
+//' @param filter row predicates (handle returned by row_filter_create, NULL to load all the rows)
+//' @param typed_genotypes if TRUE, GT, DP and AD of the genotypes are stored in the genotypes table
+//' @param top_effect policy of the top_effect table (none, first, canonical or severe)
+//' @param max_chunk maximum number of lines of a chunk
+//' @param limit maximum number of lines to be read (negative for no limit)
+//' @param queue_size maximum number of prepared chunks waiting for R
+//'
+//' @return an handle to the loader
+//[[Rcpp::export]]
+SEXP async_loader_start(std::string path, std::string table_name, std::vector<std::string> header,
+                        std::vector<int> rules, std::vector<std::string> types,
+                        std::vector<std::string> vcf_info_keys,
+                        std::vector<std::string> vcf_info_types, std::string dialect,
+                        std::string partition_by, std::vector<std::string> partitions, int partition_buckets, bool summaries,
+                        SEXP filter, bool typed_genotypes, std::string top_effect, int max_chunk, double limit, int queue_size){
+  reader_options options;
+  options.table_name = table_name;
+  options.header = header;
+  options.rules = rules;
+  options.types = types;
+  options.vcf_info_keys = vcf_info_keys;
+  options.vcf_info_types = vcf_info_types;
+  options.dialect = dialect_from_name(dialect);
+  options.partition_by = partition_by;
+  options.partitions = partitions;
+  options.partition_buckets = partition_buckets;
+  options.summaries = summaries;
+  if(filter != R_NilValue){
+    options.filter = *XPtr<row_filter>(filter);
+  }
+  options.typed_genotypes = typed_genotypes;
+  options.top_effect = top_effect_from_name(top_effect);
+  return XPtr<async_loader>(new async_loader(path, options, max_chunk, limit, queue_size), true);
+}
+
+
+//' Take the next chunk from an asynchronous MAF loader
+//'
+//' @param loader handle returned by async_loader_start
+//' @param wait if TRUE, wait for the next chunk
+//'
+//' @return a list with status ("ready", "pending" or "done"), queries (statements), lines,
+//' starting_point and partitions (found so far) of the chunk
+//[[Rcpp::export]]
+List async_loader_next(SEXP loader, bool wait){
+  XPtr<async_loader> ptr(loader);
+  prepared_chunk chunk;
+  int status = ptr->take(chunk, wait);
+  if(status != CHUNK_READY){
+    return List::create(Named("status") = status == CHUNKS_DONE ? "done" : "pending");
+  }
+  return List::create(
+    Named("status") = "ready",
+    Named("queries") = chunk.queries,
+    Named("lines") = chunk.lines,
+    Named("starting_point") = chunk.starting_point,
+    Named("partitions") = chunk.partitions
+  );
+}
+
+
+//' Summary tables of an asynchronous MAF loader
+//'
+//' to be used when all the chunks have been taken (the loader is stopped)
+//'
+//' @param loader handle returned by async_loader_start
+//'
+//' @return creation and insertion queries of the summary tables
+//[[Rcpp::export]]
+CharacterVector async_loader_summaries(SEXP loader){
+  XPtr<async_loader> ptr(loader);
+  return wrap(ptr->summaries());
+}
+
+
+//' Stop an asynchronous MAF loader
+//'
+//' @param loader handle returned by async_loader_start
+//[[Rcpp::export]]
+void async_loader_close(SEXP loader){
+  XPtr<async_loader> ptr(loader);
+  ptr->close();
+}
@@ -0,0 +1,56 @@
+// AsyncLoader.h
+
+#ifndef MAF_READER_ASYNC_LOADER
+#define MAF_READER_ASYNC_LOADER
+
+#include <Rcpp.h>
+#include <fstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <chrono>
+using namespace Rcpp;
+
+#include "Reader.h"
+
+// a chunk of the MAF file ready to be sent to the database
+
+struct prepared_chunk{
+  std::vector<std::string> queries;
+  int lines;
+  int starting_point;
+  std::vector<std::string> partitions; // partitions found so far (see maf_loader)
+};
+
+// reads and parses a MAF file in a background thread, the prepared
+// queries are kept in a bounded queue until R takes them.
+// The worker thread never calls the R API.
+
+class async_loader{
+public:
+  async_loader(std::string path, reader_options options, int max_chunk, double limit, int queue_size);
+  ~async_loader();
+  int take(prepared_chunk& out, bool wait);
+  void close();
+  std::vector<std::string> summaries();
+  std::string error; // message of the error that stopped the worker ("" for none)
+private:
+  void work();
+  bool read_lines(std::vector<std::string>& lines);
+  std::ifstream in;
+  maf_loader loader; // used only by the worker
+  int max_chunk;
+  double limit; // < 0 means no limit
+  int queue_size;
+  int line_number; // lines read after the header
+  std::deque<prepared_chunk> queue;
+  std::mutex lock;
+  std::condition_variable not_full;
+  std::condition_variable not_empty;
+  bool finished; // set by the worker
+  bool stopped; // set by R
+  std::thread worker;
+};
+
+#endif
@@ -0,0 +1,456 @@
+#include "Columnar.h"
+
+/*
+ * RULES (same as the database loader):
+ * 0: mask column (not stored)
+ * 1: text
+ * 2: numeric
+ * 3: special (stored as text, see columnar_separe_rows)
+ */
+
+
+//' Column store constructor
+//'
+//' An empty store with the given structure, rows are added
+//' with add_line until the store is sealed.
+//'
+//' @param header sequence of column names
+//' @param rules sequence of rules (text/numeric)
+column_store::column_store(std::vector<std::string> header, std::vector<int> rules){
+  assert(header.size() == rules.size());
+  this->header = header;
+  this->rules = rules;
+  this->offsets = std::vector<std::vector<size_t>>(header.size());
+  this->lengths = std::vector<std::vector<int>>(header.size());
+  this->numbers = std::vector<std::vector<double>>(header.size());
+  this->sealed = false;
+}
+
+
+//' Locate a column
+//'
+//' @param colname name of the column
+//'
+//' @return position of the column or -1 if it is not in the store
+int column_store::locate(std::string colname){
+  auto pos_it = std::find(this->header.begin(), this->header.end(), colname);
+  if(pos_it == this->header.end()){
+    return -1;
+  }
+  return std::distance(this->header.begin(), pos_it);
+}
+
+
+//' Append a text cell
+//'
+//' empty cells are NAs
+void column_store::add_text(int col, const char* text, int length){
+  this->offsets[col].push_back(this->arena.size());
+  this->lengths[col].push_back(length);
+  this->arena.append(text, length);
+}
+
+
+//' Append a numeric cell
+//'
+//' empty or non numeric cells are NAs
+void column_store::add_number(int col, const char* text, int length){
+  if(length == 0){
+    this->numbers[col].push_back(NA_REAL);
+    return;
+  }
+  std::string cell(text, length);
+  char* end;
+  double value = std::strtod(cell.c_str(), &end);
+  this->numbers[col].push_back(*end == '\0' ? value : NA_REAL);
+}
+
+
+//' Append a (tab separated) MAF line
+//'
+//' missing trailing cells are stored as NAs
+//'
+//' @param line original text
+//' @param db_index index of the line
+void column_store::add_line(const std::string& line, int db_index){
+  int ini = 0;
+  int col = 0;
+  int len = line.length();
+  for(int cursor = 0; cursor <= len && col < this->ncol(); cursor++){
+    if(cursor == len || line[cursor] == '\t'){
+      if(this->is_numeric(col)){
+        this->add_number(col, line.data() + ini, cursor - ini);
+      }else if(!this->is_masked(col)){
+        this->add_text(col, line.data() + ini, cursor - ini);
+      }
+      ini = cursor + 1;
+      col++;
+    }
+  }
+  for(; col < this->ncol(); col++){ // short line
+    if(this->is_numeric(col)){
+      this->add_number(col, "", 0);
+    }else if(!this->is_masked(col)){
+      this->add_text(col, "", 0);
+    }
+  }
+  this->db_index.push_back(db_index);
+}
+
+
+//' Memory used by the store
+//'
+//' @return allocated bytes (arena, offsets and numeric columns)
+size_t column_store::allocated_bytes(){
+  size_t out = this->arena.capacity() + this->db_index.capacity() * sizeof(int);
+  for(int j = 0; j<this->ncol(); j++){
+    out += this->offsets[j].capacity() * sizeof(size_t);
+    out += this->lengths[j].capacity() * sizeof(int);
+    out += this->numbers[j].capacity() * sizeof(double);
+  }
+  return out;
+}
+
+
+//' Collect the ALTREP columns of a view
+//'
+//' @param view view to be exported
+//' @param columns output columns
+//' @param names output names (duplicated names get a ".y" suffix)
+//' @param with_index if TRUE, db_index is the first column
+void append_view_columns(column_view& view, std::vector<RObject>& columns,
+                         std::vector<std::string>& names, bool with_index){
+  if(with_index){
+    columns.push_back(RObject(make_altrep_column(view, -1)));
+    names.push_back("db_index");
+  }
+  for(int j = 0; j<view.store->ncol(); j++){
+    if(view.store->is_masked(j)) continue;
+    std::string name = view.store->header[j];
+    while(std::find(names.begin(), names.end(), name) != names.end()){
+      name.append(".y");
+    }
+    columns.push_back(RObject(make_altrep_column(view, j)));
+    names.push_back(name);
+  }
+}
+
+
+//' Create a data.frame from a list of columns
+//'
+//' @param columns columns of the data frame
+//' @param names names of the columns
+//' @param nrow number of rows
+//'
+//' @return the data frame
+List as_data_frame(std::vector<RObject>& columns, std::vector<std::string>& names, int nrow){
+  List out(columns.size());
+  for(int j = 0; j<columns.size(); j++){
+    out[j] = columns[j];
+  }
+  out.attr("names") = wrap(names);
+  out.attr("class") = "data.frame";
+  out.attr("row.names") = IntegerVector::create(NA_INTEGER, -nrow); // compact row names
+  return out;
+}
+
+
+//' Get a view from an R handle
+column_view* as_view(SEXP view){
+  XPtr<column_view> ptr(view);
+  if(ptr.get() == NULL){
+    stop("ERROR: invalid columnar view (was the session restarted?)");
+  }
+  return ptr.get();
+}
+
+
+//' Create an empty column store
+//'
+//' @param header names of the columns
+//' @param rules list of actions to manage fields (0: skip, 1,3: text, 2: numeric)
+//'
+//' @return an handle to a view on the whole (empty) store
+//[[Rcpp::export]]
+SEXP columnar_create(CharacterVector header, IntegerVector rules){
+  auto store = std::make_shared<column_store>(
+    as<std::vector<std::string>>(header),
+    as<std::vector<int>>(rules)
+  );
+  column_view* view = new column_view();
+  view->store = store;
+  return XPtr<column_view>(view, true);
+}
+
+
+//' Add MAF lines to a column store
+//'
+//' @param view handle returned by columnar_create
+//' @param text group of maf lines (original text)
+//' @param starting_point starting index for "db_index" column
+//'
+//' @return the number of rows in the store
+//[[Rcpp::export]]
+int columnar_add(SEXP view, CharacterVector text, int starting_point){
+  column_view* v = as_view(view);
+  if(v->store->is_sealed()){
+    stop("ERROR: cannot add lines to a sealed columnar store");
+  }
+  for(int i = 0; i<text.size(); i++){
+    v->store->add_line(as<std::string>(text[i]), starting_point + i + 1);
+  }
+  return v->store->nrow();
+}
+
+
+//' Seal a column store
+//'
+//' once sealed, the store is immutable and numeric columns can be shared
+//' with R without copies.
+//'
+//' @param view handle returned by columnar_create
+//'
+//' @return the allocated bytes of the store
+//[[Rcpp::export]]
+double columnar_seal(SEXP view){
+  column_view* v = as_view(view);
+  v->store->seal();
+  return v->store->allocated_bytes();
+}
+
+
+//' Number of rows of a columnar view
+//'
+//' @param view a columnar view
+//'
+//' @return number of rows
+//[[Rcpp::export]]
+int columnar_nrow(SEXP view){
+  return as_view(view)->nrow();
+}
+
+
+//' Columnar view as a data.frame
+//'
+//' Columns are ALTREP vectors, cells are converted to R values only when
+//' accessed.
+//'
+//' @param view a columnar view
+//'
+//' @return a data.frame
+//[[Rcpp::export]]
+List columnar_as_data_frame(SEXP view){
+  column_view* v = as_view(view);
+  std::vector<RObject> columns;
+  std::vector<std::string> names;
+  append_view_columns(*v, columns, names, true);
+  return as_data_frame(columns, names, v->nrow());
+}
+
+
+//' Filter a columnar view
+//'
+//' Keeps rows whose column value is in `values` (text or numeric columns)
+//' or, for numeric columns, is in [lower, upper].
+//'
+//' @param view a columnar view
+//' @param column name of the column to test
+//' @param values accepted values (ignored if empty)
+//' @param lower lower bound for numeric columns (NA for none)
+//' @param upper upper bound for numeric columns (NA for none)
+//'
+//' @return a new view
+//[[Rcpp::export]]
+SEXP columnar_filter(SEXP view, std::string column, CharacterVector values, double lower, double upper){
+  column_view* v = as_view(view);
+  int col = v->store->locate(column);
+  if(col == -1 || v->store->is_masked(col)){
+    stop("ERROR: column " + column + " is not in the columnar store");
+  }
+
+  auto rows = std::make_shared<std::vector<int>>();
+  if(v->store->is_numeric(col)){
+    std::unordered_set<double> accepted;
+    for(int i = 0; i<values.size(); i++){
+      std::string value = as<std::string>(values[i]);
+      char* end;
+      double number = std::strtod(value.c_str(), &end);
+      if(value.empty() || *end != '\0'){
+        stop("ERROR: " + value + " is not a number, cannot filter column " + column);
+      }
+      accepted.insert(number);
+    }
+    for(int i = 0; i<v->nrow(); i++){
+      double value = v->store->number_at(v->row(i), col);
+      if(ISNAN(value)) continue;
+      if(accepted.size() > 0 && accepted.find(value) == accepted.end()) continue;
+      if(!ISNAN(lower) && value < lower) continue;
+      if(!ISNAN(upper) && value > upper) continue;
+      rows->push_back(v->row(i));
+    }
+  }else{
+    auto accepted_values = as<std::vector<std::string>>(values);
+    std::unordered_set<std::string> accepted(accepted_values.begin(), accepted_values.end());
+    for(int i = 0; i<v->nrow(); i++){
+      int r = v->row(i);
+      if(accepted.empty() || accepted.find(v->store->text(r, col)) != accepted.end()){
+        rows->push_back(r);
+      }
+    }
+  }
+
+  column_view* out = new column_view();
+  out->store = v->store;
+  out->rows = rows;
+  return XPtr<column_view>(out, true);
+}
+
+
+//' Count rows by group
+//'
+//' Equivalent to `group_by(columns) %>% summarise(n=n())`
+//'
+//' @param view a columnar view
+//' @param columns grouping columns
+//'
+//' @return a data.frame with the grouping columns and the count `n`
+//[[Rcpp::export]]
+List columnar_count(SEXP view, std::vector<std::string> columns){
+  column_view* v = as_view(view);
+  std::vector<int> cols;
+  for(auto column : columns){
+    int col = v->store->locate(column);
+    if(col == -1 || v->store->is_masked(col)){
+      stop("ERROR: column " + column + " is not in the columnar store");
+    }
+    cols.push_back(col);
+  }
+
+  // key -> group number, the first row of each group is its representative
+  std::unordered_map<std::string, int> groups;
+  std::vector<int> representative;
+  std::vector<int> counts;
+  std::string key;
+  for(int i = 0; i<v->nrow(); i++){
+    int r = v->row(i);
+    key.clear();
+    for(int col : cols){
+      if(v->store->is_numeric(col)){
+        double value = v->store->number_at(r, col);
+        key.append((const char*) &value, sizeof(double));
+      }else{
+        key.append(v->store->text_at(r, col), v->store->text_length(r, col));
+      }
+      key.push_back('\t');
+    }
+    auto hit = groups.find(key);
+    if(hit == groups.end()){
+      groups.emplace(key, counts.size());
+      representative.push_back(r);
+      counts.push_back(1);
+    }else{
+      counts[hit->second]++;
+    }
+  }
+
+  column_view keys;
+  keys.store = v->store;
+  keys.rows = std::make_shared<std::vector<int>>(representative);
+  std::vector<RObject> out_columns;
+  std::vector<std::string> out_names;
+  for(int col : cols){
+    out_columns.push_back(RObject(make_altrep_column(keys, col)));
+    out_names.push_back(v->store->header[col]);
+  }
+  out_columns.push_back(RObject(wrap(counts)));
+  out_names.push_back("n");
+  return as_data_frame(out_columns, out_names, counts.size());
+}
+
+
+//' Join two columnar views by db_index
+//'
+//' inner join, each matching pair of rows produces a row of the result
+//'
+//' @param left a columnar view
+//' @param right a columnar view
+//'
+//' @return a data.frame with the columns of both views
+//[[Rcpp::export]]
+List columnar_join(SEXP left, SEXP right){
+  column_view* l = as_view(left);
+  column_view* r = as_view(right);
+
+  std::unordered_map<int, std::vector<int>> right_rows;
+  for(int i = 0; i<r->nrow(); i++){
+    right_rows[r->store->db_index[r->row(i)]].push_back(r->row(i));
+  }
+
+  auto left_match = std::make_shared<std::vector<int>>();
+  auto right_match = std::make_shared<std::vector<int>>();
+  for(int i = 0; i<l->nrow(); i++){
+    auto hit = right_rows.find(l->store->db_index[l->row(i)]);
+    if(hit == right_rows.end()) continue;
+    for(int row : hit->second){
+      left_match->push_back(l->row(i));
+      right_match->push_back(row);
+    }
+  }
+
+  column_view left_view;
+  left_view.store = l->store;
+  left_view.rows = left_match;
+  column_view right_view;
+  right_view.store = r->store;
+  right_view.rows = right_match;
+
+  std::vector<RObject> columns;
+  std::vector<std::string> names;
+  append_view_columns(left_view, columns, names, true);
+  append_view_columns(right_view, columns, names, false);
+  return as_data_frame(columns, names, left_match->size());
+}
+
+
+//' Split a list column in rows
+//'
+//' the columnar version of text_table::separe_rows, creates a new
+//' (db_index, column) store that can be joined to its source.
+//'
+//' @param view a columnar view
+//' @param column name of the column to split
+//' @param sep separator (single character)
+//'
+//' @return a view on the new store
+//[[Rcpp::export]]
+SEXP columnar_separe_rows(SEXP view, std::string column, std::string sep){
+  column_view* v = as_view(view);
+  int col = v->store->locate(column);
+  if(col == -1 || v->store->is_masked(col) || v->store->is_numeric(col)){
+    stop("ERROR: column " + column + " is not a text column of the columnar store");
+  }
+
+  auto store = std::make_shared<column_store>(
+    std::vector<std::string>({column}),
+    std::vector<int>({1})
+  );
+  for(int i = 0; i<v->nrow(); i++){
+    int r = v->row(i);
+    const char* text = v->store->text_at(r, col);
+    int length = v->store->text_length(r, col);
+    if(length == 0) continue; /* skip null elements */
+    int ini = 0;
+    for(int cursor = 0; cursor <= length; cursor++){
+      if(cursor == length || text[cursor] == sep[0]){
+        store->add_text(0, text + ini, cursor - ini);
+        store->db_index.push_back(v->store->db_index[r]);
+        ini = cursor + 1;
+      }
+    }
+  }
+  store->seal();
+
+  column_view* out = new column_view();
+  out->store = store;
+  return XPtr<column_view>(out, true);
+}
@@ -0,0 +1,71 @@
+// Columnar.h
+
+#ifndef MAF_READER_COLUMNAR
+#define MAF_READER_COLUMNAR
+
+#include <Rcpp.h>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+using namespace Rcpp;
+
+// an in-memory columnar copy of a MAF (or of one of its derived tables)
+//
+// text cells of every column share a single arena, each text column keeps
+// only the offsets (and lengths) of its cells; numeric columns (rule 2) are
+// parsed once and stored as doubles.
+
+class column_store{
+public:
+  column_store(std::vector<std::string> header, std::vector<int> rules);
+  int nrow(){return this->db_index.size();}
+  int ncol(){return this->header.size();}
+  int locate(std::string colname);
+  bool is_numeric(int col){return this->rules.at(col) == 2;}
+  bool is_masked(int col){return this->rules.at(col) == 0;}
+  void add_line(const std::string& line, int db_index);
+  void add_text(int col, const char* text, int length);
+  void add_number(int col, const char* text, int length);
+  int text_length(int row, int col){return this->lengths[col][row];}
+  const char* text_at(int row, int col){return this->arena.data() + this->offsets[col][row];}
+  std::string text(int row, int col){return std::string(this->text_at(row, col), this->text_length(row, col));}
+  double number_at(int row, int col){return this->numbers[col][row];}
+  double* numbers_of(int col){return this->numbers[col].data();}
+  void seal(){this->sealed = true;}
+  bool is_sealed(){return this->sealed;}
+  size_t allocated_bytes();
+  std::vector<std::string> header;
+  std::vector<int> rules;
+  std::vector<int> db_index;
+private:
+  std::string arena; // shared text arena
+  std::vector<std::vector<size_t>> offsets; // per text column
+  std::vector<std::vector<int>> lengths; // per text column (0 is NA)
+  std::vector<std::vector<double>> numbers; // per numeric column
+  bool sealed;
+};
+
+// a (possibly filtered) view on a column store,
+// rows == nullptr means "all the rows of the store"
+
+struct column_view{
+  std::shared_ptr<column_store> store;
+  std::shared_ptr<std::vector<int>> rows;
+  int nrow(){return this->rows ? this->rows->size() : this->store->nrow();}
+  int row(int i){return this->rows ? this->rows->at(i) : i;}
+};
+
+// a single column of a view, used as payload of the ALTREP vectors
+// (col == -1 is the db_index column)
+
+struct column_ref{
+  column_view view;
+  int col;
+};
+
+SEXP make_altrep_column(column_view& view, int col);
+void append_view_columns(column_view& view, std::vector<RObject>& columns,
+                         std::vector<std::string>& names, bool with_index);
+List as_data_frame(std::vector<RObject>& columns, std::vector<std::string>& names, int nrow);
+
+#endif
@@ -0,0 +1,90 @@
+// Dialect.h
+
+#ifndef MAF_READER_DIALECT
+#define MAF_READER_DIALECT
+
+#include <string>
+#include <algorithm>
+
+// SQL dialects (used to select the emitter at run time, once per table)
+
+const int POSTGRESQL = 0;
+const int SQLITE = 1;
+const int DUCKDB = 2;
+
+int dialect_from_name(std::string name);
+
+// Dialect policies: each backend gets its own specialized serializer
+// (see field::echo and text_table::echo_as).
+//
+// max_rows: maximum number of rows of a single INSERT statement
+// max_statement_bytes: a statement is closed when it gets longer than this
+
+// PostgreSQL: E'' strings when backslashes are present (valid with any
+// standard_conforming_strings), unquoted identifiers are lower case,
+// queries are limited to 1GB
+
+struct postgres_dialect{
+  static const int max_rows = 50000;
+  static const size_t max_statement_bytes = 256 << 20;
+  static std::string identifier(std::string name){
+    std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+    return name;
+  }
+  static void boolean(std::string& out, bool value){
+    out.append(value ? "TRUE" : "FALSE");
+  }
+  static void quote(std::string& out, const char* text, int length){
+    bool escape = std::find(text, text + length, '\\') != text + length;
+    if(escape) out.push_back('E');
+    out.push_back('\'');
+    for(int i = 0; i<length; i++){
+      out.push_back(text[i]);
+      if(text[i] == '\'' || (escape && text[i] == '\\')){ // escape ' (and \)
+        out.push_back(text[i]);
+      }
+    }
+    out.push_back('\'');
+  }
+};
+
+// SQLite: standard strings, no boolean type (1/0),
+// SQLITE_MAX_SQL_LENGTH is 1e9 bytes by default
+
+struct sqlite_dialect{
+  static const int max_rows = 50000;
+  static const size_t max_statement_bytes = 100 << 20;
+  static std::string identifier(std::string name){
+    return name;
+  }
+  static void boolean(std::string& out, bool value){
+    out.push_back(value ? '1' : '0');
+  }
+  static void quote(std::string& out, const char* text, int length){
+    out.push_back('\'');
+    for(int i = 0; i<length; i++){
+      out.push_back(text[i]);
+      if(text[i] == '\'') out.push_back('\''); // escape '
+    }
+    out.push_back('\'');
+  }
+};
+
+// DuckDB: standard strings and booleans, long VALUES lists
+// are parsed slowly so statements are kept shorter
+
+struct duckdb_dialect{
+  static const int max_rows = 10000;
+  static const size_t max_statement_bytes = 64 << 20;
+  static std::string identifier(std::string name){
+    return name;
+  }
+  static void boolean(std::string& out, bool value){
+    out.append(value ? "true" : "false");
+  }
+  static void quote(std::string& out, const char* text, int length){
+    sqlite_dialect::quote(out, text, length);
+  }
+};
+
+#endif
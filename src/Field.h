@@ -5,28 +5,65 @@
 
 #include <Rcpp.h>
 #include <string.h>   
+#include <strings.h>
+#include "Dialect.h"
 using namespace Rcpp;
 
+/* how a field is printed */
+const int FIELD_RAW = 0;
+const int FIELD_QUOTED = 1;
+const int FIELD_BOOLEAN = 2;
+
 // a field of a table (a text table)
 
 class field{
 public: 
   field(int start, int stop, std::string* reference){
     this->start = start; this->stop = stop; this->reference = reference;
-    this->to_quote=false;
+    this->kind = FIELD_RAW;
   }
   int begin(){return this->start;}
   int end(){return this->stop;}
   int length(){return this->stop-this->start;} // stop is excluded
   char at(int i){return this->reference->at(this->start+i);}
-  void quote(){this->to_quote=true;}
-  void unquote(){this->to_quote=false;};
+  void quote(){this->kind = FIELD_QUOTED;}
+  void unquote(){this->kind = FIELD_RAW;};
+  void boolean(){this->kind = FIELD_BOOLEAN;};
   std::string* source(){return this->reference;};
-  std::string echo();
+  template<class dialect> void echo(std::string& out);
 private:
   int start,stop;
   std::string* reference;
-  bool to_quote;
+  int kind;
 };
 
-#endif 
\ No newline at end of file
+
+//' print this field in SQL format
+//'
+//' also manages NAs, quoting and booleans are managed by the dialect
+//' (booleans other than true or false, in any case, are NULL)
+//'
+//' @param out the SQL formatted field is appended here
+template<class dialect>
+void field::echo(std::string& out){
+  if(this->length()==0){
+    out.append("NULL");
+    return;
+  }
+  const char* text = this->reference->data() + this->start;
+  if(this->kind == FIELD_QUOTED){
+    dialect::quote(out, text, this->length());
+  }else if(this->kind == FIELD_BOOLEAN){
+    if(this->length() == 4 && strncasecmp(text, "true", 4) == 0){
+      dialect::boolean(out, true);
+    }else if(this->length() == 5 && strncasecmp(text, "false", 5) == 0){
+      dialect::boolean(out, false);
+    }else{
+      out.append("NULL"); // not a boolean
+    }
+  }else{
+    out.append(text, this->length());
+  }
+}
+
+#endif 
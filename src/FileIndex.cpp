@@ -0,0 +1,362 @@
+#include "FileIndex.h"
+
+/* first bytes of an index file (changes with the format) */
+const std::string INDEX_MAGIC = "MAFIDX02";
+
+/* default number of lines between indexed offsets */
+const int INDEX_STRIDE = 10000;
+
+
+//' Size and modification time of a file
+//'
+//' @param path path to the file
+//' @param size output, size in bytes
+//' @param modified output, modification time (seconds)
+//'
+//' @return false if the file cannot be accessed
+bool file_stamp(std::string path, long long& size, long long& modified){
+  struct stat info;
+  if(stat(path.c_str(), &info) != 0) return false;
+  size = info.st_size;
+  modified = info.st_mtime;
+  return true;
+}
+
+
+//' Index a MAF file
+//'
+//' One pass on the file: comments are skipped, lines are counted from
+//' the one after the header (as in maf_db_loader).
+//'
+//' @param path path to the MAF file
+//' @param stride number of lines between indexed offsets
+void maf_index::build(std::string path, int stride){
+  std::ifstream in(path, std::ios::binary);
+  long long size;
+  if(!in.good() || !file_stamp(path, size, this->modified)){
+    stop("ERROR: cannot open " + path);
+  }
+  this->stride = std::max(stride, 1);
+  this->offsets.clear();
+  this->ranges.clear();
+
+  /* header */
+  std::string line;
+  long long position = 0;
+  this->header_offset = -1;
+  while(std::getline(in, line)){
+    long long line_start = position;
+    position = in.eof() ? line_start + line.size() : (long long) in.tellg();
+    if(line != "" && line[0] != '#'){
+      this->header_offset = line_start;
+      break;
+    }
+  }
+  if(this->header_offset < 0){
+    stop("ERROR: no header in " + path);
+  }
+  if(line.size() > 0 && line.back() == '\r') line.pop_back();
+  std::transform(line.begin(), line.end(), line.begin(), ::tolower);
+  int chromosome_column = -1;
+  int col = 0;
+  for(int cursor = 0, ini = 0; cursor <= line.size(); cursor++){
+    if(cursor == line.size() || line[cursor] == '\t'){
+      if(line.compare(ini, cursor - ini, "chromosome") == 0) chromosome_column = col;
+      ini = cursor + 1;
+      col++;
+    }
+  }
+  this->data_offset = position;
+
+  /* lines */
+  this->n_lines = 0;
+  std::string chromosome;
+  while(true){
+    long long line_start = position;
+    if(!std::getline(in, line)) break;
+    position = in.eof() ? line_start + line.size() : (long long) in.tellg();
+    if(this->n_lines % this->stride == 0){
+      this->offsets.push_back(line_start);
+    }
+    if(chromosome_column >= 0){
+      /* value of the chromosome column */
+      int ini = 0;
+      col = 0;
+      chromosome.clear();
+      for(int cursor = 0; cursor <= line.size(); cursor++){
+        if(cursor == line.size() || line[cursor] == '\t' || line[cursor] == '\r'){
+          if(col == chromosome_column){
+            chromosome.assign(line, ini, cursor - ini);
+            break;
+          }
+          ini = cursor + 1;
+          col++;
+        }
+      }
+      if(this->ranges.empty() || this->ranges.back().chromosome != chromosome){
+        this->ranges.push_back({chromosome, this->n_lines, 0, line_start, line_start});
+      }
+      this->ranges.back().lines++;
+      this->ranges.back().end = position;
+    }
+    this->n_lines++;
+    if(this->n_lines % 1000000 == 0) checkUserInterrupt();
+  }
+  this->file_size = position;
+}
+
+
+/* binary I/O helpers */
+
+static void write_number(std::ofstream& out, long long value){
+  out.write((const char*) &value, sizeof(value));
+}
+
+static long long read_number(std::ifstream& in){
+  long long value = 0;
+  in.read((char*) &value, sizeof(value));
+  return value;
+}
+
+
+//' Write the index
+//'
+//' @param index_path path of the sidecar file
+void maf_index::write(std::string index_path){
+  std::ofstream out(index_path, std::ios::binary);
+  if(!out.good()){
+    stop("ERROR: cannot write " + index_path);
+  }
+  out.write(INDEX_MAGIC.data(), INDEX_MAGIC.size());
+  for(long long value : {this->file_size, this->modified, this->header_offset, this->data_offset,
+                         this->stride, this->n_lines}){
+    write_number(out, value);
+  }
+  write_number(out, this->offsets.size());
+  for(long long offset : this->offsets){
+    write_number(out, offset);
+  }
+  write_number(out, this->ranges.size());
+  for(auto& range : this->ranges){
+    write_number(out, range.chromosome.size());
+    out.write(range.chromosome.data(), range.chromosome.size());
+    for(long long value : {range.first_line, range.lines, range.begin, range.end}){
+      write_number(out, value);
+    }
+  }
+}
+
+
+//' Read the index
+//'
+//' @param index_path path of the sidecar file
+//' @param expected_size size of the MAF file (the index is stale if different)
+//' @param expected_modified modification time of the MAF file (as expected_size)
+//'
+//' @return false if the index is missing, stale or invalid
+bool maf_index::read(std::string index_path, long long expected_size, long long expected_modified){
+  std::ifstream in(index_path, std::ios::binary);
+  if(!in.good()) return false;
+  std::string magic(INDEX_MAGIC.size(), ' ');
+  in.read(&magic[0], magic.size());
+  if(magic != INDEX_MAGIC) return false;
+  this->file_size = read_number(in);
+  if(this->file_size != expected_size) return false;
+  this->modified = read_number(in);
+  if(this->modified != expected_modified) return false;
+  this->header_offset = read_number(in);
+  this->data_offset = read_number(in);
+  this->stride = read_number(in);
+  this->n_lines = read_number(in);
+  this->offsets.resize(read_number(in));
+  for(auto& offset : this->offsets){
+    offset = read_number(in);
+  }
+  this->ranges.resize(read_number(in));
+  for(auto& range : this->ranges){
+    range.chromosome.resize(read_number(in));
+    in.read(&range.chromosome[0], range.chromosome.size());
+    range.first_line = read_number(in);
+    range.lines = read_number(in);
+    range.begin = read_number(in);
+    range.end = read_number(in);
+  }
+  return in.good() && this->stride > 0;
+}
+
+
+//' Move a stream to the beginning of a line
+//'
+//' jumps to the closest indexed offset, then skips at most stride-1 lines
+//'
+//' @param in stream of the MAF file
+//' @param line line number (0 is the first line after the header)
+void maf_index::seek(std::ifstream& in, long long line){
+  in.clear();
+  if(line >= this->n_lines || this->offsets.empty()){
+    in.seekg(0, std::ios::end);
+    return;
+  }
+  long long block = line / this->stride;
+  in.seekg((std::streamoff) this->offsets[block]);
+  for(long long skip = line - block * this->stride; skip > 0; skip--){
+    in.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+  }
+}
+
+
+//' Index of a MAF file
+//'
+//' reads the sidecar file, it is (re)built if missing or stale
+//'
+//' @param path path to the MAF file
+//' @param stride number of lines between indexed offsets (when built)
+//'
+//' @return the index
+maf_index load_index(std::string path, int stride){
+  long long size, modified;
+  if(!file_stamp(path, size, modified)){
+    stop("ERROR: cannot open " + path);
+  }
+  maf_index index;
+  if(!index.read(path + ".idx", size, modified)){
+    index.build(path, stride);
+    index.write(path + ".idx");
+  }
+  return index;
+}
+
+
+//' Read a range of lines
+//'
+//' @param path path to the MAF file
+//' @param index its index
+//' @param first_line first line (0 is the first line after the header)
+//' @param n_lines number of lines
+//' @param lines output (the strings are reused)
+void read_range(std::string path, maf_index& index, long long first_line, long long n_lines,
+                std::vector<std::string>& lines){
+  if(first_line < 0){
+    stop("ERROR: the first line cannot be negative");
+  }
+  std::ifstream in(path, std::ios::binary);
+  if(!in.good()){
+    stop("ERROR: cannot open " + path);
+  }
+  index.seek(in, first_line);
+  n_lines = std::max(0LL, std::min(n_lines, index.n_lines - first_line));
+  lines.resize(n_lines);
+  long long n_read = 0;
+  while(n_read < n_lines && std::getline(in, lines[n_read])){
+    if(lines[n_read].size() > 0 && lines[n_read].back() == '\r') lines[n_read].pop_back(); // as readLines
+    n_read++;
+  }
+  lines.resize(n_read);
+}
+
+
+//' Index a MAF file
+//'
+//' Writes a sidecar file (<path>.idx) with the byte offset of every
+//' stride-th line, the position of the header and the ranges of lines
+//' of each chromosome. The index is used to read line ranges and
+//' chromosomes without scanning the file.
+//'
+//' @param path path to the MAF file
+//' @param stride number of lines between indexed offsets
+//' @param rebuild if TRUE, rebuild the index even if it is up to date
+//'
+//' @return a list with header_offset, data_offset, lines and chromosomes
+//' (data.frame of chromosome, first_line, lines, begin and end of each range)
+//[[Rcpp::export]]
+List maf_index_info(std::string path, int stride, bool rebuild){
+  maf_index index;
+  if(rebuild){
+    index.build(path, stride);
+    index.write(path + ".idx");
+  }else{
+    index = load_index(path, stride);
+  }
+  std::vector<std::string> chromosomes;
+  std::vector<double> first_lines, lines, begins, ends;
+  for(auto& range : index.ranges){
+    chromosomes.push_back(range.chromosome);
+    first_lines.push_back(range.first_line);
+    lines.push_back(range.lines);
+    begins.push_back(range.begin);
+    ends.push_back(range.end);
+  }
+  return List::create(
+    Named("header_offset") = (double) index.header_offset,
+    Named("data_offset") = (double) index.data_offset,
+    Named("lines") = (double) index.n_lines,
+    Named("chromosomes") = DataFrame::create(
+      Named("chromosome") = chromosomes,
+      Named("first_line") = first_lines,
+      Named("lines") = lines,
+      Named("begin") = begins,
+      Named("end") = ends,
+      Named("stringsAsFactors") = false
+    )
+  );
+}
+
+
+//' Read a range of lines of an indexed MAF file
+//'
+//' @param path path to the MAF file
+//' @param first_line first line (0 is the first line after the header)
+//' @param n_lines number of lines
+//'
+//' @return the lines (fewer at the end of the file)
+//[[Rcpp::export]]
+std::vector<std::string> maf_read_lines(std::string path, double first_line, double n_lines){
+  if(!(first_line >= 0) || !(n_lines >= 0)){ // also NaN
+    stop("ERROR: first_line and n_lines must be non negative numbers");
+  }
+  maf_index index = load_index(path, INDEX_STRIDE);
+  std::vector<std::string> lines;
+  read_range(path, index, first_line, n_lines, lines);
+  return lines;
+}
+
+
+//' Split an indexed MAF file in balanced ranges
+//'
+//' Ranges have about the same number of bytes and start at indexed
+//' lines, so that each one can be parsed independently (e.g. in parallel).
+//'
+//' @param path path to the MAF file
+//' @param parts number of ranges (fewer if the file is small)
+//'
+//' @return a data.frame with first_line, lines, begin and end of each range
+//[[Rcpp::export]]
+DataFrame maf_index_split(std::string path, int parts){
+  maf_index index = load_index(path, INDEX_STRIDE);
+  std::vector<double> first_lines, lines, begins, ends;
+  parts = std::max(parts, 1);
+  long long data_bytes = index.file_size - index.data_offset;
+  int block = 0; // indexed offset where the current range starts
+  for(int part = 1; part <= parts && block < index.offsets.size(); part++){
+    long long target = index.data_offset + data_bytes * part / parts;
+    int next = block + 1;
+    while(next < index.offsets.size() && index.offsets[next] < target) next++;
+    if(part == parts) next = index.offsets.size();
+    first_lines.push_back((double) block * index.stride);
+    begins.push_back(index.offsets[block]);
+    if(next < index.offsets.size()){
+      lines.push_back((double) (next - block) * index.stride);
+      ends.push_back(index.offsets[next]);
+    }else{
+      lines.push_back((double) index.n_lines - block * index.stride);
+      ends.push_back(index.file_size);
+    }
+    block = next;
+  }
+  return DataFrame::create(
+    Named("first_line") = first_lines,
+    Named("lines") = lines,
+    Named("begin") = begins,
+    Named("end") = ends
+  );
+}
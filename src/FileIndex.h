@@ -0,0 +1,41 @@
+// FileIndex.h
+
+#ifndef MAF_READER_FILE_INDEX
+#define MAF_READER_FILE_INDEX
+
+#include <Rcpp.h>
+#include <fstream>
+#include <limits>
+#include <sys/stat.h>
+using namespace Rcpp;
+
+// a run of consecutive lines of the same chromosome
+
+struct chromosome_range{
+  std::string chromosome;
+  long long first_line; // 0 is the first line after the header
+  long long lines;
+  long long begin, end; // byte offsets
+};
+
+// sidecar index of a MAF file (<file>.idx): byte offset of every
+// stride-th line, position of the header and chromosome ranges.
+// It is stale when the size or the modification time of the file change.
+
+class maf_index{
+public:
+  void build(std::string path, int stride);
+  void write(std::string index_path);
+  bool read(std::string index_path, long long expected_size, long long expected_modified);
+  void seek(std::ifstream& in, long long line);
+  long long file_size, modified, header_offset, data_offset, stride, n_lines;
+  std::vector<long long> offsets;
+  std::vector<chromosome_range> ranges;
+};
+
+bool file_stamp(std::string path, long long& size, long long& modified);
+maf_index load_index(std::string path, int stride);
+void read_range(std::string path, maf_index& index, long long first_line, long long n_lines,
+                std::vector<std::string>& lines);
+
+#endif
@@ -0,0 +1,322 @@
+#include "Inference.h"
+
+/* candidate separators for list-like columns */
+const std::string LIST_SEPARATORS = ";,|&";
+
+/* a column is list-like if a separator is found in at least this fraction of its cells */
+const double LIST_THRESHOLD = 0.1;
+
+
+//' Column guess constructor
+//'
+//' every type is possible until a cell proves otherwise
+column_guess::column_guess(){
+  this->can_be_integer = true;
+  this->can_be_float = true;
+  this->can_be_boolean = true;
+  this->max_length = 0;
+  this->observed = 0;
+  this->separators = std::vector<int>(LIST_SEPARATORS.size(), 0);
+  this->fits_integer = true;
+}
+
+
+//' Update the guess with a new cell
+//'
+//' empty cells are NULLs and do not give information on the type
+//'
+//' @param text beginning of the cell
+//' @param length length of the cell
+void column_guess::observe(const char* text, int length){
+  if(length == 0) return;
+  this->observed++;
+  this->max_length = std::max(this->max_length, length);
+
+  /* integer and float: the same tests of the loader (see conforms), so that
+     the inferred type never turns the values into NULLs */
+  std::string cell(text, length);
+  field value(0, length, &cell);
+  if(this->can_be_integer){
+    if(!conforms(&value, "bigint")){
+      this->can_be_integer = false;
+    }else if(!conforms(&value, "integer")){
+      this->fits_integer = false;
+    }
+  }
+  if(this->can_be_float && !this->can_be_integer && !conforms(&value, "float")){
+    this->can_be_float = false;
+  }
+
+  /* boolean: true/false in any case (valid SQL literals) */
+  if(this->can_be_boolean && !conforms(&value, "boolean")){
+    this->can_be_boolean = false;
+  }
+
+  /* list-like columns */
+  for(int s = 0; s<LIST_SEPARATORS.size(); s++){
+    if(memchr(text, LIST_SEPARATORS[s], length) != NULL){
+      this->separators[s]++;
+    }
+  }
+}
+
+
+//' SQL type of the column
+//'
+//' @return integer, bigint, float, boolean or varchar
+std::string column_guess::type(){
+  if(this->observed == 0) return "varchar"; /* all NULLs, no information */
+  if(this->can_be_boolean) return "boolean";
+  if(this->can_be_integer) return this->fits_integer ? "integer" : "bigint";
+  if(this->can_be_float) return "float";
+  return "varchar";
+}
+
+
+//' Separator of a list-like column
+//'
+//' @return the most frequent separator or 0 if the column is not list-like
+char column_guess::list_separator(){
+  if(this->type() != "varchar") return 0;
+  int best = -1;
+  for(int s = 0; s<LIST_SEPARATORS.size(); s++){
+    if(this->separators[s] >= LIST_THRESHOLD * this->observed &&
+       (best == -1 || this->separators[s] > this->separators[best])){
+      best = s;
+    }
+  }
+  return best == -1 ? 0 : LIST_SEPARATORS[best];
+}
+
+
+//' Visit a sample of the lines of a MAF file
+//'
+//' The sample is made of `blocks` evenly spaced blocks of lines for a total of
+//' about `max_bytes` bytes (a single block reads the beginning of the file).
+//' The header line is skipped.
+//'
+//' @param path path to the MAF file
+//' @param max_bytes size of the sample
+//' @param blocks number of blocks in which the sample is split
+//' @param on_comment called on comment lines (starting with #)
+//' @param on_line called on each sampled data line
+void sample_lines(std::string path, double max_bytes, int blocks,
+                  std::function<void(std::string&)> on_comment,
+                  std::function<void(std::string&)> on_line){
+  std::ifstream in(path, std::ios::binary);
+  if(!in.good()){
+    stop("ERROR: cannot open " + path);
+  }
+  in.seekg(0, std::ios::end);
+  double file_size = in.tellg();
+  in.seekg(0, std::ios::beg);
+  blocks = std::max(blocks, 1);
+
+  std::string line;
+  bool header_found = false;
+  for(int b = 0; b<blocks; b++){
+    double block_start = b * file_size / blocks;
+    if(b > 0){
+      in.clear();
+      in.seekg((std::streamoff) block_start);
+      std::getline(in, line); // partial line
+      header_found = true; // the header is at the beginning of the file
+    }
+    double read_bytes = 0;
+    while(read_bytes < max_bytes / blocks && std::getline(in, line)){
+      read_bytes += line.size() + 1;
+      if(line.size() == 0) continue;
+      if(line[0] == '#'){
+        on_comment(line);
+        continue;
+      }
+      if(!header_found){ // first non comment line
+        header_found = true;
+        continue;
+      }
+      on_line(line);
+    }
+  }
+}
+
+
+//' Infer the type of MAF columns from a sample of the file
+//'
+//' (see sample_lines for the sampling strategy)
+//'
+//' @param path path to the MAF file
+//' @param columns positions (1-based) of the columns to be inferred
+//' @param max_bytes size of the sample
+//' @param blocks number of blocks in which the sample is split
+//'
+//' @return a data.frame with position, type, max_length, list_sep and number of
+//' non null observations of each column
+//[[Rcpp::export]]
+DataFrame infer_column_types(std::string path, std::vector<int> columns, double max_bytes, int blocks){
+  /* position (0-based) -> guess */
+  int last_column = 0;
+  for(int c : columns) last_column = std::max(last_column, c);
+  std::vector<int> target(last_column, -1);
+  for(int i = 0; i<columns.size(); i++) target[columns[i]-1] = i;
+  std::vector<column_guess> guesses(columns.size());
+
+  sample_lines(path, max_bytes, blocks, [](std::string& line){}, [&](std::string& line){
+    /* tokenize (only up to the last column of interest) */
+    int ini = 0;
+    int col = 0;
+    for(int cursor = 0; cursor <= line.size() && col < last_column; cursor++){
+      if(cursor == line.size() || line[cursor] == '\t'){
+        if(target[col] != -1){
+          guesses[target[col]].observe(line.data() + ini, cursor - ini);
+        }
+        ini = cursor + 1;
+        col++;
+      }
+    }
+  });
+
+  std::vector<std::string> types;
+  std::vector<int> max_lengths;
+  std::vector<std::string> list_seps;
+  std::vector<int> observed;
+  for(auto& guess : guesses){
+    types.push_back(guess.type());
+    max_lengths.push_back(guess.max_length);
+    char sep = guess.list_separator();
+    list_seps.push_back(sep == 0 ? "" : std::string(1, sep));
+    observed.push_back(guess.observed);
+  }
+
+  return DataFrame::create(
+    Named("position") = columns,
+    Named("type") = types,
+    Named("max_length") = max_lengths,
+    Named("list_sep") = list_seps,
+    Named("observed") = observed,
+    Named("stringsAsFactors") = false
+  );
+}
+
+
+//' Get an attribute of a ##INFO header line
+//'
+//' @param line the header line (##INFO=<ID=DP,Number=1,Type=Integer,...>)
+//' @param attribute name of the attribute (ID, Number, Type)
+//'
+//' @return the value of the attribute ("" if missing)
+std::string info_attribute(std::string& line, std::string attribute){
+  size_t pos = line.find("<" + attribute + "=");
+  if(pos == std::string::npos){
+    pos = line.find("," + attribute + "=");
+  }
+  if(pos == std::string::npos){
+    return "";
+  }
+  size_t begin = pos + attribute.size() + 2;
+  size_t end = line.find_first_of(",>", begin);
+  return line.substr(begin, end == std::string::npos ? std::string::npos : end - begin);
+}
+
+
+//' Infer the keys of the vcf_info column and their types
+//'
+//' Keys declared in ##INFO header lines use the declared type (keys with
+//' Number different from 1 are lists and are considered varchar), the
+//' other keys are inferred from a sample of the file (see sample_lines);
+//' keys without a value are flags (boolean).
+//'
+//' @param path path to the MAF file
+//' @param column position (1-based) of the vcf_info column
+//' @param max_bytes size of the sample
+//' @param blocks number of blocks in which the sample is split
+//'
+//' @return a data.frame with key, type and source (header or sample) of each key
+//[[Rcpp::export]]
+DataFrame infer_vcf_info_keys(std::string path, int column, double max_bytes, int blocks){
+  std::vector<std::string> keys;
+  std::vector<std::string> sources;
+  std::unordered_map<std::string, std::string> declared;
+  std::unordered_map<std::string, int> sampled; // key -> guess
+  std::vector<column_guess> guesses;
+  std::vector<bool> is_flag;
+
+  auto on_comment = [&](std::string& line){
+    if(line.compare(0, 7, "##INFO=") != 0) return;
+    std::string key = info_attribute(line, "ID");
+    std::string number = info_attribute(line, "Number");
+    std::string type = info_attribute(line, "Type");
+    if(key == "" || declared.count(key) > 0) return;
+    if(type == "Flag"){
+      declared[key] = "boolean";
+    }else if(number != "1"){
+      declared[key] = "varchar";
+    }else if(type == "Integer"){
+      declared[key] = "bigint"; // the header does not bound the values
+    }else if(type == "Float"){
+      declared[key] = "float";
+    }else{
+      declared[key] = "varchar";
+    }
+    keys.push_back(key);
+    sources.push_back("header");
+  };
+
+  auto on_line = [&](std::string& line){
+    /* locate the vcf_info cell */
+    size_t begin = 0;
+    for(int col = 1; col < column && begin != std::string::npos; col++){
+      begin = line.find('\t', begin);
+      if(begin != std::string::npos) begin++;
+    }
+    if(begin == std::string::npos) return;
+    size_t end = line.find('\t', begin);
+    if(end == std::string::npos) end = line.size();
+
+    /* key=value;key=value;flag */
+    size_t ini = begin;
+    while(ini < end){
+      size_t stop = line.find(';', ini);
+      if(stop == std::string::npos || stop > end) stop = end;
+      size_t eq = line.find('=', ini);
+      bool flag = (eq == std::string::npos || eq >= stop);
+      std::string key = line.substr(ini, (flag ? stop : eq) - ini);
+      ini = stop + 1;
+      if(key == "" || declared.count(key) > 0) continue;
+      auto hit = sampled.find(key);
+      int g;
+      if(hit == sampled.end()){
+        g = guesses.size();
+        sampled[key] = g;
+        guesses.push_back(column_guess());
+        is_flag.push_back(true);
+        keys.push_back(key);
+        sources.push_back("sample");
+      }else{
+        g = hit->second;
+      }
+      if(!flag){
+        is_flag[g] = false;
+        guesses[g].observe(line.data() + eq + 1, stop - eq - 1);
+      }
+    }
+  };
+
+  sample_lines(path, max_bytes, blocks, on_comment, on_line);
+
+  std::vector<std::string> types;
+  for(int i = 0; i<keys.size(); i++){
+    if(sources[i] == "header"){
+      types.push_back(declared[keys[i]]);
+    }else{
+      int g = sampled[keys[i]];
+      types.push_back(is_flag[g] ? "boolean" : guesses[g].type());
+    }
+  }
+
+  return DataFrame::create(
+    Named("key") = keys,
+    Named("type") = types,
+    Named("source") = sources,
+    Named("stringsAsFactors") = false
+  );
+}
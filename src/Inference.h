@@ -0,0 +1,37 @@
+// Inference.h
+
+#ifndef MAF_READER_INFERENCE
+#define MAF_READER_INFERENCE
+
+#include <Rcpp.h>
+#include <fstream>
+#include <cstring>
+#include <functional>
+#include <unordered_map>
+using namespace Rcpp;
+
+#include "Utils.h"
+
+// what has been observed on the sampled cells of a column
+
+class column_guess{
+public:
+  column_guess();
+  void observe(const char* text, int length);
+  std::string type();
+  char list_separator();
+  int max_length;
+  int observed; // non null cells
+private:
+  bool can_be_integer, can_be_float, can_be_boolean;
+  bool fits_integer; // every integer fits a 32 bit int (otherwise bigint)
+  std::vector<int> separators; // cells containing each candidate separator
+};
+
+void sample_lines(std::string path, double max_bytes, int blocks,
+                  std::function<void(std::string&)> on_comment,
+                  std::function<void(std::string&)> on_line);
+DataFrame infer_column_types(std::string path, std::vector<int> columns, double max_bytes, int blocks);
+DataFrame infer_vcf_info_keys(std::string path, int column, double max_bytes, int blocks);
+
+#endif
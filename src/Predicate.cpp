@@ -0,0 +1,220 @@
+#include "Predicate.h"
+
+
+//' Row filter constructor
+//'
+//' without conditions every line is accepted
+row_filter::row_filter(){
+  this->last_column = -1;
+  this->region_chromosome = this->region_start = this->region_end = -1;
+  this->rejected = 0;
+}
+
+
+//' Cell slot of a column
+//'
+//' @param column position of the column in the header of the file
+//'
+//' @return the slot of the column in cells (created if needed)
+int row_filter::slot(int column){
+  if(column >= this->slots.size()){
+    this->slots.resize(column + 1, -1);
+  }
+  if(this->slots[column] < 0){
+    this->slots[column] = this->cells.size();
+    this->cells.push_back(field(0, 0, NULL));
+  }
+  this->last_column = std::max(this->last_column, column);
+  return this->slots[column];
+}
+
+
+//' Equality/set membership condition
+//'
+//' @param column position of the column
+//' @param values accepted values (as in the file)
+void row_filter::add_values(int column, std::vector<std::string> values){
+  this->values.push_back(std::make_pair(this->slot(column),
+                                        std::unordered_set<std::string>(values.begin(), values.end())));
+}
+
+
+//' Numeric range condition
+//'
+//' NULL and non numeric values are rejected
+//'
+//' @param column position of the column
+//' @param lower lower bound (included, NaN for no bound)
+//' @param upper upper bound (included, NaN for no bound)
+void row_filter::add_range(int column, double lower, double upper){
+  this->ranges.push_back(std::make_pair(this->slot(column), std::make_pair(lower, upper)));
+}
+
+
+//' Genomic regions condition
+//'
+//' a line is accepted if [start, end] overlaps one of the regions, the
+//' regions are BED intervals (0-based, end excluded) while MAF positions
+//' are 1-based. Chromosome names are compared without "chr".
+//'
+//' @param chromosome position of the chromosome column
+//' @param start position of the start column
+//' @param end position of the end column
+//' @param chromosomes chromosome of each region
+//' @param starts start of each region
+//' @param ends end of each region
+void row_filter::add_regions(int chromosome, int start, int end, std::vector<std::string> chromosomes,
+                             std::vector<double> starts, std::vector<double> ends){
+  this->region_chromosome = this->slot(chromosome);
+  this->region_start = this->slot(start);
+  this->region_end = this->slot(end);
+  for(int i = 0; i<chromosomes.size(); i++){
+    this->regions[chromosome_name(chromosomes[i].data(), chromosomes[i].size())]
+      .push_back(std::make_pair(starts[i] + 1, ends[i]));
+  }
+  /* sort and merge, so that ends are increasing (binary search) */
+  for(auto& entry : this->regions){
+    auto& intervals = entry.second;
+    std::sort(intervals.begin(), intervals.end());
+    int merged = 0;
+    for(int i = 1; i<intervals.size(); i++){
+      if(intervals[i].first <= intervals[merged].second + 1){
+        intervals[merged].second = std::max(intervals[merged].second, intervals[i].second);
+      }else{
+        intervals[++merged] = intervals[i];
+      }
+    }
+    intervals.resize(std::min((int) intervals.size(), merged + 1));
+  }
+}
+
+
+//' Numeric value of a cell
+//'
+//' @param slot slot of the cell
+//' @param value output
+//'
+//' @return false if the cell is NULL or not a number
+bool row_filter::number(int slot, double& value){
+  field& cell = this->cells[slot];
+  if(cell.length() == 0) return false;
+  this->buffer.assign(cell.source()->data() + cell.begin(), cell.length());
+  char* stop;
+  value = std::strtod(this->buffer.c_str(), &stop);
+  return *stop == '\0';
+}
+
+
+//' Test a line
+//'
+//' locates the tested cells (the line is scanned up to the last tested
+//' column) and evaluates all the conditions
+//'
+//' @param line the raw line
+//'
+//' @return true if the line satisfies all the conditions
+bool row_filter::accept(field& line){
+  for(field& cell : this->cells){ /* short line */
+    cell = field(line.end(), line.end(), line.source());
+  }
+  int ini = 0;
+  int col = 0;
+  for(int cursor = 0; col <= this->last_column && cursor <= line.length(); cursor++){
+    if(cursor == line.length() || line.at(cursor) == '\t'){
+      if(this->slots[col] >= 0){
+        this->cells[this->slots[col]] = field(line.begin()+ini, line.begin()+cursor, line.source());
+      }
+      ini = cursor+1;
+      col++;
+    }
+  }
+
+  bool accepted = true;
+  for(auto& condition : this->values){
+    field& cell = this->cells[condition.first];
+    this->buffer.assign(cell.source()->data() + cell.begin(), cell.length());
+    if(condition.second.find(this->buffer) == condition.second.end()){
+      accepted = false;
+      break;
+    }
+  }
+  for(int i = 0; accepted && i<this->ranges.size(); i++){
+    double value;
+    auto& bounds = this->ranges[i].second;
+    accepted = this->number(this->ranges[i].first, value) &&
+      !(value < bounds.first) && !(value > bounds.second); // NaN bounds are open
+  }
+  if(accepted && this->region_chromosome >= 0){
+    field& cell = this->cells[this->region_chromosome];
+    auto hit = this->regions.find(chromosome_name(cell.source()->data() + cell.begin(), cell.length()));
+    double start, end;
+    accepted = hit != this->regions.end() && this->number(this->region_start, start);
+    if(accepted){
+      if(!this->number(this->region_end, end)) end = start;
+      /* first region ending after start */
+      auto region = std::lower_bound(hit->second.begin(), hit->second.end(), start,
+                                     [](const std::pair<double, double>& r, double x){return r.second < x;});
+      accepted = region != hit->second.end() && region->first <= end;
+    }
+  }
+
+  if(!accepted) this->rejected++;
+  return accepted;
+}
+
+
+//' Chromosome name without the "chr" prefix
+//'
+//' @param text the name
+//' @param length its length
+//'
+//' @return the name to be compared
+std::string chromosome_name(const char* text, int length){
+  if(length > 3 && strncasecmp(text, "chr", 3) == 0){
+    return std::string(text + 3, length - 3);
+  }
+  return std::string(text, length);
+}
+
+
+//' Create a row filter
+//'
+//' Predicates of a load, passed to maf_loader_create or async_loader_start.
+//' All the conditions must hold.
+//'
+//' @param header names of the columns of the file
+//' @param value_columns columns with a set of accepted values
+//' @param values accepted values of each column (a list)
+//' @param range_columns columns with a numeric range
+//' @param lower lower bound of each range (NA for no bound)
+//' @param upper upper bound of each range (NA for no bound)
+//' @param region_chromosomes chromosome of each region (empty for no regions)
+//' @param region_starts start of each region (0-based, as in BED files)
+//' @param region_ends end of each region (excluded)
+//'
+//' @return an handle to the filter
+//[[Rcpp::export]]
+SEXP row_filter_create(std::vector<std::string> header, std::vector<std::string> value_columns, List values,
+                       std::vector<std::string> range_columns, std::vector<double> lower, std::vector<double> upper,
+                       std::vector<std::string> region_chromosomes, std::vector<double> region_starts,
+                       std::vector<double> region_ends){
+  auto position = [&header](std::string column){
+    auto pos_it = std::find(header.begin(), header.end(), column);
+    if(pos_it == header.end()){
+      stop("ERROR: cannot filter by " + column + ", column not found");
+    }
+    return (int) std::distance(header.begin(), pos_it);
+  };
+  std::unique_ptr<row_filter> filter(new row_filter());
+  for(int i = 0; i<value_columns.size(); i++){
+    filter->add_values(position(value_columns[i]), as<std::vector<std::string>>(values[i]));
+  }
+  for(int i = 0; i<range_columns.size(); i++){
+    filter->add_range(position(range_columns[i]), lower[i], upper[i]);
+  }
+  if(region_chromosomes.size() > 0){
+    filter->add_regions(position("chromosome"), position("start_position"), position("end_position"),
+                        region_chromosomes, region_starts, region_ends);
+  }
+  return XPtr<row_filter>(filter.release(), true);
+}
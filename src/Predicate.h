@@ -0,0 +1,44 @@
+// Predicate.h
+
+#ifndef MAF_READER_PREDICATE
+#define MAF_READER_PREDICATE
+
+#include <Rcpp.h>
+#include <strings.h>
+#include <memory>
+#include <unordered_set>
+#include <unordered_map>
+using namespace Rcpp;
+
+#include "Field.h"
+
+// row predicates of a load (conjunction of all the conditions), tested on
+// the raw line before tokenization: only the needed columns are located.
+// Columns are positions in the header of the file.
+
+class row_filter{
+public:
+  row_filter();
+  void add_values(int column, std::vector<std::string> values);
+  void add_range(int column, double lower, double upper);
+  void add_regions(int chromosome, int start, int end, std::vector<std::string> chromosomes,
+                   std::vector<double> starts, std::vector<double> ends);
+  bool active(){return this->last_column >= 0;}
+  bool accept(field& line);
+  long long rejected; // lines rejected so far
+private:
+  int slot(int column);
+  bool number(int slot, double& value);
+  std::vector<int> slots; // column -> cell slot (-1 if not tested)
+  std::vector<field> cells; // tested cells of the current line
+  int last_column; // -1 if there are no predicates
+  std::vector<std::pair<int, std::unordered_set<std::string>>> values; // slot -> accepted values
+  std::vector<std::pair<int, std::pair<double, double>>> ranges; // slot -> [lower, upper]
+  int region_chromosome, region_start, region_end; // slots (-1 without regions)
+  std::unordered_map<std::string, std::vector<std::pair<double, double>>> regions; // sorted, merged
+  std::string buffer;
+};
+
+std::string chromosome_name(const char* text, int length);
+
+#endif
@@ -5,9 +5,265 @@
 
 using namespace Rcpp;
 
+// async_loader_start
+SEXP async_loader_start(std::string path, std::string table_name, std::vector<std::string> header, std::vector<int> rules, std::vector<std::string> types, std::vector<std::string> vcf_info_keys, std::vector<std::string> vcf_info_types, std::string dialect, std::string partition_by, std::vector<std::string> partitions, int partition_buckets, bool summaries, SEXP filter, bool typed_genotypes, std::string top_effect, int max_chunk, double limit, int queue_size);
+RcppExport SEXP _rMAFdb_async_loader_start(SEXP pathSEXP, SEXP table_nameSEXP, SEXP headerSEXP, SEXP rulesSEXP, SEXP typesSEXP, SEXP vcf_info_keysSEXP, SEXP vcf_info_typesSEXP, SEXP dialectSEXP, SEXP partition_bySEXP, SEXP partitionsSEXP, SEXP partition_bucketsSEXP, SEXP summariesSEXP, SEXP filterSEXP, SEXP typed_genotypesSEXP, SEXP top_effectSEXP, SEXP max_chunkSEXP, SEXP limitSEXP, SEXP queue_sizeSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< std::string >::type path(pathSEXP);
+    Rcpp::traits::input_parameter< std::string >::type table_name(table_nameSEXP);
+    Rcpp::traits::input_parameter< std::vector<std::string> >::type header(headerSEXP);
+    Rcpp::traits::input_parameter< std::vector<int> >::type rules(rulesSEXP);
+    Rcpp::traits::input_parameter< std::vector<std::string> >::type types(typesSEXP);
+    Rcpp::traits::input_parameter< std::vector<std::string> >::type vcf_info_keys(vcf_info_keysSEXP);
+    Rcpp::traits::input_parameter< std::vector<std::string> >::type vcf_info_types(vcf_info_typesSEXP);
+    Rcpp::traits::input_parameter< std::string >::type dialect(dialectSEXP);
+    Rcpp::traits::input_parameter< std::string >::type partition_by(partition_bySEXP);
+    Rcpp::traits::input_parameter< std::vector<std::string> >::type partitions(partitionsSEXP);
+    Rcpp::traits::input_parameter< int >::type partition_buckets(partition_bucketsSEXP);
+    Rcpp::traits::input_parameter< bool >::type summaries(summariesSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type filter(filterSEXP);
+    Rcpp::traits::input_parameter< bool >::type typed_genotypes(typed_genotypesSEXP);
+    Rcpp::traits::input_parameter< std::string >::type top_effect(top_effectSEXP);
+    Rcpp::traits::input_parameter< int >::type max_chunk(max_chunkSEXP);
+    Rcpp::traits::input_parameter< double >::type limit(limitSEXP);
+    Rcpp::traits::input_parameter< int >::type queue_size(queue_sizeSEXP);
+    rcpp_result_gen = Rcpp::wrap(async_loader_start(path, table_name, header, rules, types, vcf_info_keys, vcf_info_types, dialect, partition_by, partitions, partition_buckets, summaries, filter, typed_genotypes, top_effect, max_chunk, limit, queue_size));
+    return rcpp_result_gen;
+END_RCPP
+}
+// async_loader_next
+List async_loader_next(SEXP loader, bool wait);
+RcppExport SEXP _rMAFdb_async_loader_next(SEXP loaderSEXP, SEXP waitSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type loader(loaderSEXP);
+    Rcpp::traits::input_parameter< bool >::type wait(waitSEXP);
+    rcpp_result_gen = Rcpp::wrap(async_loader_next(loader, wait));
+    return rcpp_result_gen;
+END_RCPP
+}
+// async_loader_summaries
+CharacterVector async_loader_summaries(SEXP loader);
+RcppExport SEXP _rMAFdb_async_loader_summaries(SEXP loaderSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type loader(loaderSEXP);
+    rcpp_result_gen = Rcpp::wrap(async_loader_summaries(loader));
+    return rcpp_result_gen;
+END_RCPP
+}
+// async_loader_close
+void async_loader_close(SEXP loader);
+RcppExport SEXP _rMAFdb_async_loader_close(SEXP loaderSEXP) {
+BEGIN_RCPP
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type loader(loaderSEXP);
+    async_loader_close(loader);
+    return R_NilValue;
+END_RCPP
+}
+// columnar_create
+SEXP columnar_create(CharacterVector header, IntegerVector rules);
+RcppExport SEXP _rMAFdb_columnar_create(SEXP headerSEXP, SEXP rulesSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< CharacterVector >::type header(headerSEXP);
+    Rcpp::traits::input_parameter< IntegerVector >::type rules(rulesSEXP);
+    rcpp_result_gen = Rcpp::wrap(columnar_create(header, rules));
+    return rcpp_result_gen;
+END_RCPP
+}
+// columnar_add
+int columnar_add(SEXP view, CharacterVector text, int starting_point);
+RcppExport SEXP _rMAFdb_columnar_add(SEXP viewSEXP, SEXP textSEXP, SEXP starting_pointSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type view(viewSEXP);
+    Rcpp::traits::input_parameter< CharacterVector >::type text(textSEXP);
+    Rcpp::traits::input_parameter< int >::type starting_point(starting_pointSEXP);
+    rcpp_result_gen = Rcpp::wrap(columnar_add(view, text, starting_point));
+    return rcpp_result_gen;
+END_RCPP
+}
+// columnar_seal
+double columnar_seal(SEXP view);
+RcppExport SEXP _rMAFdb_columnar_seal(SEXP viewSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type view(viewSEXP);
+    rcpp_result_gen = Rcpp::wrap(columnar_seal(view));
+    return rcpp_result_gen;
+END_RCPP
+}
+// columnar_nrow
+int columnar_nrow(SEXP view);
+RcppExport SEXP _rMAFdb_columnar_nrow(SEXP viewSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type view(viewSEXP);
+    rcpp_result_gen = Rcpp::wrap(columnar_nrow(view));
+    return rcpp_result_gen;
+END_RCPP
+}
+// columnar_as_data_frame
+List columnar_as_data_frame(SEXP view);
+RcppExport SEXP _rMAFdb_columnar_as_data_frame(SEXP viewSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type view(viewSEXP);
+    rcpp_result_gen = Rcpp::wrap(columnar_as_data_frame(view));
+    return rcpp_result_gen;
+END_RCPP
+}
+// columnar_filter
+SEXP columnar_filter(SEXP view, std::string column, CharacterVector values, double lower, double upper);
+RcppExport SEXP _rMAFdb_columnar_filter(SEXP viewSEXP, SEXP columnSEXP, SEXP valuesSEXP, SEXP lowerSEXP, SEXP upperSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type view(viewSEXP);
+    Rcpp::traits::input_parameter< std::string >::type column(columnSEXP);
+    Rcpp::traits::input_parameter< CharacterVector >::type values(valuesSEXP);
+    Rcpp::traits::input_parameter< double >::type lower(lowerSEXP);
+    Rcpp::traits::input_parameter< double >::type upper(upperSEXP);
+    rcpp_result_gen = Rcpp::wrap(columnar_filter(view, column, values, lower, upper));
+    return rcpp_result_gen;
+END_RCPP
+}
+// columnar_count
+List columnar_count(SEXP view, std::vector<std::string> columns);
+RcppExport SEXP _rMAFdb_columnar_count(SEXP viewSEXP, SEXP columnsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type view(viewSEXP);
+    Rcpp::traits::input_parameter< std::vector<std::string> >::type columns(columnsSEXP);
+    rcpp_result_gen = Rcpp::wrap(columnar_count(view, columns));
+    return rcpp_result_gen;
+END_RCPP
+}
+// columnar_join
+List columnar_join(SEXP left, SEXP right);
+RcppExport SEXP _rMAFdb_columnar_join(SEXP leftSEXP, SEXP rightSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type left(leftSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type right(rightSEXP);
+    rcpp_result_gen = Rcpp::wrap(columnar_join(left, right));
+    return rcpp_result_gen;
+END_RCPP
+}
+// columnar_separe_rows
+SEXP columnar_separe_rows(SEXP view, std::string column, std::string sep);
+RcppExport SEXP _rMAFdb_columnar_separe_rows(SEXP viewSEXP, SEXP columnSEXP, SEXP sepSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type view(viewSEXP);
+    Rcpp::traits::input_parameter< std::string >::type column(columnSEXP);
+    Rcpp::traits::input_parameter< std::string >::type sep(sepSEXP);
+    rcpp_result_gen = Rcpp::wrap(columnar_separe_rows(view, column, sep));
+    return rcpp_result_gen;
+END_RCPP
+}
+// maf_index_info
+List maf_index_info(std::string path, int stride, bool rebuild);
+RcppExport SEXP _rMAFdb_maf_index_info(SEXP pathSEXP, SEXP strideSEXP, SEXP rebuildSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< std::string >::type path(pathSEXP);
+    Rcpp::traits::input_parameter< int >::type stride(strideSEXP);
+    Rcpp::traits::input_parameter< bool >::type rebuild(rebuildSEXP);
+    rcpp_result_gen = Rcpp::wrap(maf_index_info(path, stride, rebuild));
+    return rcpp_result_gen;
+END_RCPP
+}
+// maf_read_lines
+std::vector<std::string> maf_read_lines(std::string path, double first_line, double n_lines);
+RcppExport SEXP _rMAFdb_maf_read_lines(SEXP pathSEXP, SEXP first_lineSEXP, SEXP n_linesSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< std::string >::type path(pathSEXP);
+    Rcpp::traits::input_parameter< double >::type first_line(first_lineSEXP);
+    Rcpp::traits::input_parameter< double >::type n_lines(n_linesSEXP);
+    rcpp_result_gen = Rcpp::wrap(maf_read_lines(path, first_line, n_lines));
+    return rcpp_result_gen;
+END_RCPP
+}
+// maf_index_split
+DataFrame maf_index_split(std::string path, int parts);
+RcppExport SEXP _rMAFdb_maf_index_split(SEXP pathSEXP, SEXP partsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< std::string >::type path(pathSEXP);
+    Rcpp::traits::input_parameter< int >::type parts(partsSEXP);
+    rcpp_result_gen = Rcpp::wrap(maf_index_split(path, parts));
+    return rcpp_result_gen;
+END_RCPP
+}
+// infer_column_types
+DataFrame infer_column_types(std::string path, std::vector<int> columns, double max_bytes, int blocks);
+RcppExport SEXP _rMAFdb_infer_column_types(SEXP pathSEXP, SEXP columnsSEXP, SEXP max_bytesSEXP, SEXP blocksSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< std::string >::type path(pathSEXP);
+    Rcpp::traits::input_parameter< std::vector<int> >::type columns(columnsSEXP);
+    Rcpp::traits::input_parameter< double >::type max_bytes(max_bytesSEXP);
+    Rcpp::traits::input_parameter< int >::type blocks(blocksSEXP);
+    rcpp_result_gen = Rcpp::wrap(infer_column_types(path, columns, max_bytes, blocks));
+    return rcpp_result_gen;
+END_RCPP
+}
+// infer_vcf_info_keys
+DataFrame infer_vcf_info_keys(std::string path, int column, double max_bytes, int blocks);
+RcppExport SEXP _rMAFdb_infer_vcf_info_keys(SEXP pathSEXP, SEXP columnSEXP, SEXP max_bytesSEXP, SEXP blocksSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< std::string >::type path(pathSEXP);
+    Rcpp::traits::input_parameter< int >::type column(columnSEXP);
+    Rcpp::traits::input_parameter< double >::type max_bytes(max_bytesSEXP);
+    Rcpp::traits::input_parameter< int >::type blocks(blocksSEXP);
+    rcpp_result_gen = Rcpp::wrap(infer_vcf_info_keys(path, column, max_bytes, blocks));
+    return rcpp_result_gen;
+END_RCPP
+}
+// row_filter_create
+SEXP row_filter_create(std::vector<std::string> header, std::vector<std::string> value_columns, List values, std::vector<std::string> range_columns, std::vector<double> lower, std::vector<double> upper, std::vector<std::string> region_chromosomes, std::vector<double> region_starts, std::vector<double> region_ends);
+RcppExport SEXP _rMAFdb_row_filter_create(SEXP headerSEXP, SEXP value_columnsSEXP, SEXP valuesSEXP, SEXP range_columnsSEXP, SEXP lowerSEXP, SEXP upperSEXP, SEXP region_chromosomesSEXP, SEXP region_startsSEXP, SEXP region_endsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< std::vector<std::string> >::type header(headerSEXP);
+    Rcpp::traits::input_parameter< std::vector<std::string> >::type value_columns(value_columnsSEXP);
+    Rcpp::traits::input_parameter< List >::type values(valuesSEXP);
+    Rcpp::traits::input_parameter< std::vector<std::string> >::type range_columns(range_columnsSEXP);
+    Rcpp::traits::input_parameter< std::vector<double> >::type lower(lowerSEXP);
+    Rcpp::traits::input_parameter< std::vector<double> >::type upper(upperSEXP);
+    Rcpp::traits::input_parameter< std::vector<std::string> >::type region_chromosomes(region_chromosomesSEXP);
+    Rcpp::traits::input_parameter< std::vector<double> >::type region_starts(region_startsSEXP);
+    Rcpp::traits::input_parameter< std::vector<double> >::type region_ends(region_endsSEXP);
+    rcpp_result_gen = Rcpp::wrap(row_filter_create(header, value_columns, values, range_columns, lower, upper, region_chromosomes, region_starts, region_ends));
+    return rcpp_result_gen;
+END_RCPP
+}
 // maf_db_reader
-CharacterVector maf_db_reader(CharacterVector table_name, CharacterVector text, CharacterVector header, IntegerVector rules, int starting_point);
-RcppExport SEXP _rMAFdb_maf_db_reader(SEXP table_nameSEXP, SEXP textSEXP, SEXP headerSEXP, SEXP rulesSEXP, SEXP starting_pointSEXP) {
+CharacterVector maf_db_reader(CharacterVector table_name, CharacterVector text, CharacterVector header, IntegerVector rules, int starting_point, CharacterVector vcf_info_keys, CharacterVector vcf_info_types, std::string dialect);
+RcppExport SEXP _rMAFdb_maf_db_reader(SEXP table_nameSEXP, SEXP textSEXP, SEXP headerSEXP, SEXP rulesSEXP, SEXP starting_pointSEXP, SEXP vcf_info_keysSEXP, SEXP vcf_info_typesSEXP, SEXP dialectSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
@@ -16,7 +272,105 @@ BEGIN_RCPP
     Rcpp::traits::input_parameter< CharacterVector >::type header(headerSEXP);
     Rcpp::traits::input_parameter< IntegerVector >::type rules(rulesSEXP);
     Rcpp::traits::input_parameter< int >::type starting_point(starting_pointSEXP);
-    rcpp_result_gen = Rcpp::wrap(maf_db_reader(table_name, text, header, rules, starting_point));
+    Rcpp::traits::input_parameter< CharacterVector >::type vcf_info_keys(vcf_info_keysSEXP);
+    Rcpp::traits::input_parameter< CharacterVector >::type vcf_info_types(vcf_info_typesSEXP);
+    Rcpp::traits::input_parameter< std::string >::type dialect(dialectSEXP);
+    rcpp_result_gen = Rcpp::wrap(maf_db_reader(table_name, text, header, rules, starting_point, vcf_info_keys, vcf_info_types, dialect));
+    return rcpp_result_gen;
+END_RCPP
+}
+// maf_loader_create
+SEXP maf_loader_create(std::string table_name, std::vector<std::string> header, std::vector<int> rules, std::vector<std::string> types, std::vector<std::string> vcf_info_keys, std::vector<std::string> vcf_info_types, std::string dialect, std::string partition_by, std::vector<std::string> partitions, int partition_buckets, bool summaries, SEXP filter, bool typed_genotypes, std::string top_effect);
+RcppExport SEXP _rMAFdb_maf_loader_create(SEXP table_nameSEXP, SEXP headerSEXP, SEXP rulesSEXP, SEXP typesSEXP, SEXP vcf_info_keysSEXP, SEXP vcf_info_typesSEXP, SEXP dialectSEXP, SEXP partition_bySEXP, SEXP partitionsSEXP, SEXP partition_bucketsSEXP, SEXP summariesSEXP, SEXP filterSEXP, SEXP typed_genotypesSEXP, SEXP top_effectSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< std::string >::type table_name(table_nameSEXP);
+    Rcpp::traits::input_parameter< std::vector<std::string> >::type header(headerSEXP);
+    Rcpp::traits::input_parameter< std::vector<int> >::type rules(rulesSEXP);
+    Rcpp::traits::input_parameter< std::vector<std::string> >::type types(typesSEXP);
+    Rcpp::traits::input_parameter< std::vector<std::string> >::type vcf_info_keys(vcf_info_keysSEXP);
+    Rcpp::traits::input_parameter< std::vector<std::string> >::type vcf_info_types(vcf_info_typesSEXP);
+    Rcpp::traits::input_parameter< std::string >::type dialect(dialectSEXP);
+    Rcpp::traits::input_parameter< std::string >::type partition_by(partition_bySEXP);
+    Rcpp::traits::input_parameter< std::vector<std::string> >::type partitions(partitionsSEXP);
+    Rcpp::traits::input_parameter< int >::type partition_buckets(partition_bucketsSEXP);
+    Rcpp::traits::input_parameter< bool >::type summaries(summariesSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type filter(filterSEXP);
+    Rcpp::traits::input_parameter< bool >::type typed_genotypes(typed_genotypesSEXP);
+    Rcpp::traits::input_parameter< std::string >::type top_effect(top_effectSEXP);
+    rcpp_result_gen = Rcpp::wrap(maf_loader_create(table_name, header, rules, types, vcf_info_keys, vcf_info_types, dialect, partition_by, partitions, partition_buckets, summaries, filter, typed_genotypes, top_effect));
+    return rcpp_result_gen;
+END_RCPP
+}
+// maf_loader_read
+CharacterVector maf_loader_read(SEXP loader, CharacterVector text, int starting_point);
+RcppExport SEXP _rMAFdb_maf_loader_read(SEXP loaderSEXP, SEXP textSEXP, SEXP starting_pointSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type loader(loaderSEXP);
+    Rcpp::traits::input_parameter< CharacterVector >::type text(textSEXP);
+    Rcpp::traits::input_parameter< int >::type starting_point(starting_pointSEXP);
+    rcpp_result_gen = Rcpp::wrap(maf_loader_read(loader, text, starting_point));
+    return rcpp_result_gen;
+END_RCPP
+}
+// maf_loader_read_sampled
+CharacterVector maf_loader_read_sampled(SEXP loader, CharacterVector text, std::vector<int> line_numbers);
+RcppExport SEXP _rMAFdb_maf_loader_read_sampled(SEXP loaderSEXP, SEXP textSEXP, SEXP line_numbersSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type loader(loaderSEXP);
+    Rcpp::traits::input_parameter< CharacterVector >::type text(textSEXP);
+    Rcpp::traits::input_parameter< std::vector<int> >::type line_numbers(line_numbersSEXP);
+    rcpp_result_gen = Rcpp::wrap(maf_loader_read_sampled(loader, text, line_numbers));
+    return rcpp_result_gen;
+END_RCPP
+}
+// maf_loader_partitions
+std::vector<std::string> maf_loader_partitions(SEXP loader);
+RcppExport SEXP _rMAFdb_maf_loader_partitions(SEXP loaderSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type loader(loaderSEXP);
+    rcpp_result_gen = Rcpp::wrap(maf_loader_partitions(loader));
+    return rcpp_result_gen;
+END_RCPP
+}
+// maf_partition_buckets
+std::vector<int> maf_partition_buckets(std::vector<std::string> values, int buckets);
+RcppExport SEXP _rMAFdb_maf_partition_buckets(SEXP valuesSEXP, SEXP bucketsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< std::vector<std::string> >::type values(valuesSEXP);
+    Rcpp::traits::input_parameter< int >::type buckets(bucketsSEXP);
+    rcpp_result_gen = Rcpp::wrap(maf_partition_buckets(values, buckets));
+    return rcpp_result_gen;
+END_RCPP
+}
+// maf_loader_summaries
+CharacterVector maf_loader_summaries(SEXP loader);
+RcppExport SEXP _rMAFdb_maf_loader_summaries(SEXP loaderSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type loader(loaderSEXP);
+    rcpp_result_gen = Rcpp::wrap(maf_loader_summaries(loader));
+    return rcpp_result_gen;
+END_RCPP
+}
+// maf_loader_allocated_bytes
+double maf_loader_allocated_bytes(SEXP loader);
+RcppExport SEXP _rMAFdb_maf_loader_allocated_bytes(SEXP loaderSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type loader(loaderSEXP);
+    rcpp_result_gen = Rcpp::wrap(maf_loader_allocated_bytes(loader));
     return rcpp_result_gen;
 END_RCPP
 }
@@ -35,14 +389,152 @@ BEGIN_RCPP
     return rcpp_result_gen;
 END_RCPP
 }
+// result_cache_key
+std::string result_cache_key(std::string text);
+RcppExport SEXP _rMAFdb_result_cache_key(SEXP textSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< std::string >::type text(textSEXP);
+    rcpp_result_gen = Rcpp::wrap(result_cache_key(text));
+    return rcpp_result_gen;
+END_RCPP
+}
+// result_cache_write
+double result_cache_write(std::string path, std::string key, List columns);
+RcppExport SEXP _rMAFdb_result_cache_write(SEXP pathSEXP, SEXP keySEXP, SEXP columnsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< std::string >::type path(pathSEXP);
+    Rcpp::traits::input_parameter< std::string >::type key(keySEXP);
+    Rcpp::traits::input_parameter< List >::type columns(columnsSEXP);
+    rcpp_result_gen = Rcpp::wrap(result_cache_write(path, key, columns));
+    return rcpp_result_gen;
+END_RCPP
+}
+// result_cache_read
+SEXP result_cache_read(std::string path, std::string key);
+RcppExport SEXP _rMAFdb_result_cache_read(SEXP pathSEXP, SEXP keySEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< std::string >::type path(pathSEXP);
+    Rcpp::traits::input_parameter< std::string >::type key(keySEXP);
+    rcpp_result_gen = Rcpp::wrap(result_cache_read(path, key));
+    return rcpp_result_gen;
+END_RCPP
+}
+// maf_sample
+List maf_sample(std::string path, int size, std::string strata, double seed);
+RcppExport SEXP _rMAFdb_maf_sample(SEXP pathSEXP, SEXP sizeSEXP, SEXP strataSEXP, SEXP seedSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< std::string >::type path(pathSEXP);
+    Rcpp::traits::input_parameter< int >::type size(sizeSEXP);
+    Rcpp::traits::input_parameter< std::string >::type strata(strataSEXP);
+    Rcpp::traits::input_parameter< double >::type seed(seedSEXP);
+    rcpp_result_gen = Rcpp::wrap(maf_sample(path, size, strata, seed));
+    return rcpp_result_gen;
+END_RCPP
+}
+// matrix_builder_create
+SEXP matrix_builder_create(std::string values, std::vector<std::string> classifications, std::vector<std::string> filters);
+RcppExport SEXP _rMAFdb_matrix_builder_create(SEXP valuesSEXP, SEXP classificationsSEXP, SEXP filtersSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< std::string >::type values(valuesSEXP);
+    Rcpp::traits::input_parameter< std::vector<std::string> >::type classifications(classificationsSEXP);
+    Rcpp::traits::input_parameter< std::vector<std::string> >::type filters(filtersSEXP);
+    rcpp_result_gen = Rcpp::wrap(matrix_builder_create(values, classifications, filters));
+    return rcpp_result_gen;
+END_RCPP
+}
+// matrix_builder_add
+void matrix_builder_add(SEXP builder, std::vector<std::string> genes, std::vector<std::string> samples, std::vector<std::string> classifications, std::vector<std::string> filters);
+RcppExport SEXP _rMAFdb_matrix_builder_add(SEXP builderSEXP, SEXP genesSEXP, SEXP samplesSEXP, SEXP classificationsSEXP, SEXP filtersSEXP) {
+BEGIN_RCPP
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type builder(builderSEXP);
+    Rcpp::traits::input_parameter< std::vector<std::string> >::type genes(genesSEXP);
+    Rcpp::traits::input_parameter< std::vector<std::string> >::type samples(samplesSEXP);
+    Rcpp::traits::input_parameter< std::vector<std::string> >::type classifications(classificationsSEXP);
+    Rcpp::traits::input_parameter< std::vector<std::string> >::type filters(filtersSEXP);
+    matrix_builder_add(builder, genes, samples, classifications, filters);
+    return R_NilValue;
+END_RCPP
+}
+// matrix_builder_result
+List matrix_builder_result(SEXP builder);
+RcppExport SEXP _rMAFdb_matrix_builder_result(SEXP builderSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type builder(builderSEXP);
+    rcpp_result_gen = Rcpp::wrap(matrix_builder_result(builder));
+    return rcpp_result_gen;
+END_RCPP
+}
+// matrix_from_maf
+List matrix_from_maf(std::string path, std::string values, std::vector<std::string> classifications, std::vector<std::string> filters);
+RcppExport SEXP _rMAFdb_matrix_from_maf(SEXP pathSEXP, SEXP valuesSEXP, SEXP classificationsSEXP, SEXP filtersSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< std::string >::type path(pathSEXP);
+    Rcpp::traits::input_parameter< std::string >::type values(valuesSEXP);
+    Rcpp::traits::input_parameter< std::vector<std::string> >::type classifications(classificationsSEXP);
+    Rcpp::traits::input_parameter< std::vector<std::string> >::type filters(filtersSEXP);
+    rcpp_result_gen = Rcpp::wrap(matrix_from_maf(path, values, classifications, filters));
+    return rcpp_result_gen;
+END_RCPP
+}
 
 static const R_CallMethodDef CallEntries[] = {
-    {"_rMAFdb_maf_db_reader", (DL_FUNC) &_rMAFdb_maf_db_reader, 5},
+    {"_rMAFdb_async_loader_start", (DL_FUNC) &_rMAFdb_async_loader_start, 18},
+    {"_rMAFdb_async_loader_next", (DL_FUNC) &_rMAFdb_async_loader_next, 2},
+    {"_rMAFdb_async_loader_summaries", (DL_FUNC) &_rMAFdb_async_loader_summaries, 1},
+    {"_rMAFdb_async_loader_close", (DL_FUNC) &_rMAFdb_async_loader_close, 1},
+    {"_rMAFdb_columnar_create", (DL_FUNC) &_rMAFdb_columnar_create, 2},
+    {"_rMAFdb_columnar_add", (DL_FUNC) &_rMAFdb_columnar_add, 3},
+    {"_rMAFdb_columnar_seal", (DL_FUNC) &_rMAFdb_columnar_seal, 1},
+    {"_rMAFdb_columnar_nrow", (DL_FUNC) &_rMAFdb_columnar_nrow, 1},
+    {"_rMAFdb_columnar_as_data_frame", (DL_FUNC) &_rMAFdb_columnar_as_data_frame, 1},
+    {"_rMAFdb_columnar_filter", (DL_FUNC) &_rMAFdb_columnar_filter, 5},
+    {"_rMAFdb_columnar_count", (DL_FUNC) &_rMAFdb_columnar_count, 2},
+    {"_rMAFdb_columnar_join", (DL_FUNC) &_rMAFdb_columnar_join, 2},
+    {"_rMAFdb_columnar_separe_rows", (DL_FUNC) &_rMAFdb_columnar_separe_rows, 3},
+    {"_rMAFdb_maf_index_info", (DL_FUNC) &_rMAFdb_maf_index_info, 3},
+    {"_rMAFdb_maf_read_lines", (DL_FUNC) &_rMAFdb_maf_read_lines, 3},
+    {"_rMAFdb_maf_index_split", (DL_FUNC) &_rMAFdb_maf_index_split, 2},
+    {"_rMAFdb_infer_column_types", (DL_FUNC) &_rMAFdb_infer_column_types, 4},
+    {"_rMAFdb_infer_vcf_info_keys", (DL_FUNC) &_rMAFdb_infer_vcf_info_keys, 4},
+    {"_rMAFdb_row_filter_create", (DL_FUNC) &_rMAFdb_row_filter_create, 9},
+    {"_rMAFdb_maf_db_reader", (DL_FUNC) &_rMAFdb_maf_db_reader, 8},
+    {"_rMAFdb_maf_loader_create", (DL_FUNC) &_rMAFdb_maf_loader_create, 14},
+    {"_rMAFdb_maf_loader_read", (DL_FUNC) &_rMAFdb_maf_loader_read, 3},
+    {"_rMAFdb_maf_loader_read_sampled", (DL_FUNC) &_rMAFdb_maf_loader_read_sampled, 3},
+    {"_rMAFdb_maf_loader_partitions", (DL_FUNC) &_rMAFdb_maf_loader_partitions, 1},
+    {"_rMAFdb_maf_partition_buckets", (DL_FUNC) &_rMAFdb_maf_partition_buckets, 2},
+    {"_rMAFdb_maf_loader_summaries", (DL_FUNC) &_rMAFdb_maf_loader_summaries, 1},
+    {"_rMAFdb_maf_loader_allocated_bytes", (DL_FUNC) &_rMAFdb_maf_loader_allocated_bytes, 1},
     {"_rMAFdb_test_MAFdb", (DL_FUNC) &_rMAFdb_test_MAFdb, 5},
+    {"_rMAFdb_result_cache_key", (DL_FUNC) &_rMAFdb_result_cache_key, 1},
+    {"_rMAFdb_result_cache_write", (DL_FUNC) &_rMAFdb_result_cache_write, 3},
+    {"_rMAFdb_result_cache_read", (DL_FUNC) &_rMAFdb_result_cache_read, 2},
+    {"_rMAFdb_maf_sample", (DL_FUNC) &_rMAFdb_maf_sample, 4},
+    {"_rMAFdb_matrix_builder_create", (DL_FUNC) &_rMAFdb_matrix_builder_create, 3},
+    {"_rMAFdb_matrix_builder_add", (DL_FUNC) &_rMAFdb_matrix_builder_add, 5},
+    {"_rMAFdb_matrix_builder_result", (DL_FUNC) &_rMAFdb_matrix_builder_result, 1},
+    {"_rMAFdb_matrix_from_maf", (DL_FUNC) &_rMAFdb_matrix_from_maf, 4},
     {NULL, NULL, 0}
 };
 
+void init_columnar_altrep(DllInfo* dll);
 RcppExport void R_init_rMAFdb(DllInfo *dll) {
     R_registerRoutines(dll, NULL, CallEntries, NULL, NULL);
     R_useDynamicSymbols(dll, FALSE);
+    init_columnar_altrep(dll);
 }
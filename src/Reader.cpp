@@ -2,171 +2,719 @@
 
 /*
  * RULES:
+ * 0: skip (column not loaded)
  * 1: quote
  * 2: do not quote
  * 3: special (quote in main table)
+ * 4: boolean
  */
 
 //' Prepare queries to store a maf file in a database
 //'
-//' -- tested with PostgreSQL --
+//' -- tested with PostgreSQL, SQLite and DuckDB dialects are also available --
 //'
 //' @param table_name name of the db table
 //' @param text group of maf lines (original text)
 //' @param header names of the columns
-//' @param rules list of actions to manage fields (quoting)
+//' @param rules list of actions to manage fields (quoting, 0 skips the column)
 //' @param starting_point starting index for "db_index" column (primary key)
+//' @param vcf_info_keys keys of the wide vcf_info table (empty, the default, for a key/value table)
+//' @param vcf_info_types types of the keys (integer, bigint, float, boolean, varchar)
+//' @param dialect SQL dialect of the queries (postgresql, the default, sqlite or duckdb)
 //'
 //' Function exported for R
-//' @return the necessary insertion query to load MAF data into a database
+//' @return the necessary insertion queries to load MAF data into a database (one statement per string)
 //' @export
 //[[Rcpp::export]]
 CharacterVector maf_db_reader(CharacterVector table_name, CharacterVector text, CharacterVector header,
-                              IntegerVector rules, int starting_point){
+                              IntegerVector rules, int starting_point,
+                              CharacterVector vcf_info_keys = CharacterVector::create(),
+                              CharacterVector vcf_info_types = CharacterVector::create(),
+                              std::string dialect = "postgresql"){
 
   /* manage R types */
-  std::vector<std::string> _header = as<std::vector<std::string>>(header);
-  std::vector<int> _rules = as<std::vector<int>>(rules);
+  reader_options options;
+  options.table_name = as<std::string>(table_name);
+  options.header = as<std::vector<std::string>>(header);
+  options.rules = as<std::vector<int>>(rules);
+  options.vcf_info_keys = as<std::vector<std::string>>(vcf_info_keys);
+  options.vcf_info_types = as<std::vector<std::string>>(vcf_info_types);
+  options.dialect = dialect_from_name(dialect);
   std::vector<std::string> _text = as<std::vector<std::string>>(text);
-  std::string _table_name = as<std::string>(table_name);
 
-  //Rcout << header << "\n";
-  //Rcout << rules << "\n";
+  maf_loader loader(options);
+  return wrap(loader.read(_text, starting_point));
+}
 
-  /* main table */
-  text_table main_table = text_table(&_header, &_rules, _table_name, starting_point);
 
-  // prepare main table
-  for(int i = 0; i<_text.size(); i++){
-    /* read it line by line */
-    field* line_field = new field(0,_text[i].length(), &(_text[i]));
+//' Create a MAF loader
+//'
+//' The loader keeps its tables (and their memory) between chunks, use
+//' it instead of maf_db_reader to load a whole file.
+//'
+//' @param table_name name of the db table
+//' @param header names of the columns
+//' @param rules list of actions to manage fields (see maf_db_reader)
+//' @param types types of the columns ("" if unknown), values of unquoted columns
+//' that are not valid for their type are stored as NULL
+//' @param vcf_info_keys keys of the wide vcf_info table (empty for a key/value table)
+//' @param vcf_info_types types of the keys
+//' @param dialect SQL dialect of the queries (postgresql, sqlite or duckdb)
+//' @param partition_by name of the partition column (empty for no partitions)
+//' @param partitions values of the existing partitions
+//' @param partition_buckets number of partitions (the values are hashed, see maf_partition_buckets)
+//' @param summaries if TRUE, count genes per sample, classifications, impacts and filters
+//' @param filter row predicates (handle returned by row_filter_create, NULL to load all the rows)
+//' @param typed_genotypes if TRUE, GT, DP and AD of the genotypes are stored in the genotypes table
+//' @param top_effect policy of the top_effect table (none, first, canonical or severe)
+//'
+//' @return an handle to the loader
+//[[Rcpp::export]]
+SEXP maf_loader_create(std::string table_name, std::vector<std::string> header, std::vector<int> rules,
+                       std::vector<std::string> types, std::vector<std::string> vcf_info_keys, std::vector<std::string> vcf_info_types,
+                       std::string dialect, std::string partition_by, std::vector<std::string> partitions,
+                       int partition_buckets, bool summaries, SEXP filter, bool typed_genotypes, std::string top_effect){
+  reader_options options;
+  options.table_name = table_name;
+  options.header = header;
+  options.rules = rules;
+  options.types = types;
+  options.vcf_info_keys = vcf_info_keys;
+  options.vcf_info_types = vcf_info_types;
+  options.dialect = dialect_from_name(dialect);
+  options.partition_by = partition_by;
+  options.partitions = partitions;
+  options.partition_buckets = partition_buckets;
+  options.summaries = summaries;
+  if(filter != R_NilValue){
+    options.filter = *XPtr<row_filter>(filter);
+  }
+  options.typed_genotypes = typed_genotypes;
+  options.top_effect = top_effect_from_name(top_effect);
+  return XPtr<maf_loader>(new maf_loader(options), true);
+}
 
-    int col_position = 0;
-    auto line_tok = tokenize(line_field, '\t');
-    for(field* cell : *(line_tok) ){
-      if(_rules.at(col_position) == 1 || _rules.at(col_position) == 3){ /* quote if necessary */
-        cell->quote();
-      }
-      main_table.add(cell);
-      col_position++;
-    }
-    /* cleanup */
-    delete(line_tok);
-    delete(line_field);
+
+//' Prepare the queries of a chunk with a MAF loader
+//'
+//' @param loader handle returned by maf_loader_create
+//' @param text group of maf lines (original text)
+//' @param starting_point starting index for "db_index" column (primary key)
+//'
+//' @return the necessary insertion queries to load MAF data into a database (one statement per string)
+//[[Rcpp::export]]
+CharacterVector maf_loader_read(SEXP loader, CharacterVector text, int starting_point){
+  XPtr<maf_loader> ptr(loader);
+  /* copy the text in the buffers of the loader (their memory is reused) */
+  ptr->lines.resize(text.size());
+  for(int i = 0; i<text.size(); i++){
+    ptr->lines[i].assign(CHAR(STRING_ELT(text, i)));
   }
+  return wrap(ptr->read(ptr->lines, starting_point));
+}
 
-  //--------------------------------------------------------------------------------
 
-  /* output */
-  std::string output_query = "";
-  output_query.append(main_table.echo());
+//' Prepare the queries of sampled lines with a MAF loader
+//'
+//' as maf_loader_read, but the lines are not consecutive: each one
+//' keeps its original line number as db_index (see maf_sample)
+//'
+//' @param loader handle returned by maf_loader_create
+//' @param text group of maf lines (original text)
+//' @param line_numbers line number of each line (0 is the first line after the header)
+//'
+//' @return the necessary insertion queries to load MAF data into a database (one statement per string)
+//[[Rcpp::export]]
+CharacterVector maf_loader_read_sampled(SEXP loader, CharacterVector text, std::vector<int> line_numbers){
+  XPtr<maf_loader> ptr(loader);
+  if(line_numbers.size() != text.size()){
+    stop("ERROR: a line number is needed for each line");
+  }
+  ptr->lines.resize(text.size());
+  for(int i = 0; i<text.size(); i++){
+    ptr->lines[i].assign(CHAR(STRING_ELT(text, i)));
+  }
+  return wrap(ptr->read(ptr->lines, 0, &line_numbers));
+}
 
-  //--------------------------------------------------------------------------------
+
+//' Partitions of a MAF loader
+//'
+//' @param loader handle returned by maf_loader_create
+//'
+//' @return the values of the partition column found so far ("" for NULL),
+//' in order of discovery
+//[[Rcpp::export]]
+std::vector<std::string> maf_loader_partitions(SEXP loader){
+  XPtr<maf_loader> ptr(loader);
+  return ptr->partitions;
+}
+
+
+//' Partition of some values of the partition column
+//'
+//' @param values values of the partition column ("" for NULL)
+//' @param buckets number of partitions
+//'
+//' @return the partition (from 0 to buckets-1) of each value
+//[[Rcpp::export]]
+std::vector<int> maf_partition_buckets(std::vector<std::string> values, int buckets){
+  if(buckets < 1){
+    stop("ERROR: the number of partitions must be positive");
+  }
+  std::vector<int> out;
+  for(auto& value : values){
+    out.push_back(partition_bucket(value, buckets));
+  }
+  return out;
+}
+
+
+//' Summary tables of a MAF loader
+//'
+//' @param loader handle returned by maf_loader_create
+//'
+//' @return creation and insertion queries of the summary tables
+//[[Rcpp::export]]
+CharacterVector maf_loader_summaries(SEXP loader){
+  XPtr<maf_loader> ptr(loader);
+  return wrap(ptr->summaries());
+}
+
+
+//' Memory used by a MAF loader
+//'
+//' @param loader handle returned by maf_loader_create
+//'
+//' @return allocated bytes (tables, buffers and text of the last chunk)
+//[[Rcpp::export]]
+double maf_loader_allocated_bytes(SEXP loader){
+  XPtr<maf_loader> ptr(loader);
+  return ptr->allocated_bytes();
+}
+
+
+/* list columns, each one is splitted in a table with its own name */
+const std::vector<std::string> LIST_COLUMNS =
+  {"dbsnp_val_status", "consequence", "existing_variation", "refseq", "pubmed", "filter", "gdc_filter"};
+
+
+//' MAF loader constructor
+//'
+//' Creates all the tables required by the loaded columns.
+//'
+//' @param options table name, structure and loading options
+maf_loader::maf_loader(reader_options options){
+  this->options = options;
+
+  /* projection: skipped (rule 0) columns are never tokenized nor expanded */
+  for(int j = 0; j<options.header.size(); j++){
+    if(options.rules.at(j) == 0) continue;
+    this->header.push_back(options.header[j]);
+    this->rules.push_back(options.rules[j]);
+    /* unquoted values are written as they are: they must be valid literals */
+    std::string type = j < options.types.size() ? options.types[j] : "";
+    if(options.rules[j] == 4){
+      this->checks.push_back("boolean");
+    }else if(options.rules[j] == 2){
+      bool known = type == "integer" || type == "bigint" || type == "float";
+      this->checks.push_back(known ? type : "float");
+    }else{
+      this->checks.push_back("");
+    }
+  }
+  if(this->header.empty()){
+    stop("ERROR: none of the selected columns is in the MAF file");
+  }
+  std::vector<std::string>* _header = &this->header;
+  std::vector<int>* _rules = &this->rules;
+
+  this->main_table = this->add_table(this->header, this->rules, options.table_name);
+  this->emitted.push_back(this->main_table);
+
+  /* partitions */
+  this->partition_column = -1;
+  if(options.partition_by != ""){
+    auto pos_it = std::find(this->header.begin(), this->header.end(), options.partition_by);
+    if(pos_it == this->header.end()){
+      stop("ERROR: cannot partition by " + options.partition_by + ", column not loaded");
+    }
+    if(options.partition_buckets < 1){
+      stop("ERROR: the number of partitions must be positive");
+    }
+    this->partition_column = std::distance(this->header.begin(), pos_it);
+    for(auto& value : options.partitions){
+      this->partition_ids[value] = this->partitions.size();
+      this->partitions.push_back(value);
+      this->partition_bucket_of.push_back(partition_bucket(value, options.partition_buckets));
+    }
+  }
 
   /* separe rows, manage lists */
+  for(auto& column : LIST_COLUMNS){
+    if(locate_and_test(column, 3, _header, _rules)){
+      this->lists.push_back(std::make_pair(column, this->add_table({column}, {1}, column)));
+      this->emitted.push_back(this->lists.back().second);
+    }
+  }
+
+  /* domains */
+  this->domains = this->domains_kv = NULL;
+  if(locate_and_test("domains", 3, _header, _rules)){
+    this->domains = this->add_table({"domains"}, {1}, "domains");
+    this->domains_kv = this->add_table({"key","value"}, {1,1}, "domains");
+    this->emitted.push_back(this->domains_kv);
+  }
+
+  /* vcf_info */
+  this->vcf_info = this->vcf_info_kv = this->vcf_info_wide = this->vcf_info_other = NULL;
+  if(locate_and_test("vcf_info", 3, _header, _rules) && options.vcf_info_keys.size() > 0){
+    /* wide table, unknown keys in vcf_info_other */
+    std::vector<int> wide_rules;
+    for(auto& type : options.vcf_info_types){
+      wide_rules.push_back(type == "varchar" ? 1 : (type == "boolean" ? 4 : 2));
+    }
+    this->vcf_info_wide = this->add_table(options.vcf_info_keys, wide_rules, "vcf_info");
+    this->vcf_info_other = this->add_table({"key","value"}, {1,1}, "vcf_info_other");
+    this->emitted.push_back(this->vcf_info_wide);
+    this->emitted.push_back(this->vcf_info_other);
+  }else if(locate_and_test("vcf_info", 3, _header, _rules)){
+    this->vcf_info = this->add_table({"vcf_info"}, {1}, "vcf_info");
+    this->vcf_info_kv = this->add_table({"key","value"}, {1,1}, "vcf_info");
+    this->emitted.push_back(this->vcf_info_kv);
+  }
+
+  /* kv_merge for tumor and normal genotypes */
+  this->vcf_tumor_gt = this->vcf_normal_gt = NULL;
+  bool has_vcf_format = std::find(_header->begin(), _header->end(), "vcf_format") != _header->end();
+  if(has_vcf_format && locate_and_test("vcf_tumor_gt", 3, _header, _rules)){
+    this->vcf_tumor_gt = this->add_table({"key","value"}, {1,1}, "vcf_tumor_gt");
+    this->emitted.push_back(this->vcf_tumor_gt);
+  }
+  if(has_vcf_format && locate_and_test("vcf_normal_gt", 3, _header, _rules)){
+    this->vcf_normal_gt = this->add_table({"key","value"}, {1,1}, "vcf_normal_gt");
+    this->emitted.push_back(this->vcf_normal_gt);
+  }
+  /* typed genotypes, the other FORMAT keys stay in the key/value tables */
+  this->genotypes = NULL;
+  if(options.typed_genotypes && (this->vcf_tumor_gt != NULL || this->vcf_normal_gt != NULL)){
+    this->genotypes = this->add_table({"role","gt","dp","ref_depth","alt_depth","vaf"}, {1,1,2,2,2,2}, "genotypes");
+    this->emitted.push_back(this->genotypes);
+  }
 
-  if(locate_and_test("dbsnp_val_status", 3, &_header, &_rules)){
-    auto dbsnp_val_status = main_table.separe_rows("dbsnp_val_status", "dbsnp_val_status", ';');
-    output_query.append(dbsnp_val_status->echo());
-    delete(dbsnp_val_status);
+  /* VEP */
+  this->all_effects = this->all_effects_table = this->sift_vep = this->polyphen_vep = NULL;
+  if(locate_and_test("all_effects", 3, _header, _rules)){
+    this->all_effects = this->add_table({"all_effects"}, {1}, "all_effects");
+    this->all_effects_table = this->add_table(
+      {"symbol","consequence","hgvsp_short","transcript_id",
+       "refseq","hgvsc","impact","canonical","sift","polyphen","strand"},
+      {1,1,1,1,1,1,1,1,0,0,2}, "all_effects");
+    this->sift_vep = this->add_table({"classification","score"}, {1,2}, "sift_vep");
+    this->polyphen_vep = this->add_table({"classification","score"}, {1,2}, "polyphen_vep");
+    this->emitted.insert(this->emitted.end(), {this->all_effects_table, this->sift_vep, this->polyphen_vep});
+  }
+  /* one effect per variant, with SIFT and PolyPhen scores */
+  this->top_effect = NULL;
+  if(this->all_effects != NULL && options.top_effect != TOP_EFFECT_NONE){
+    this->top_effect = this->add_table(
+      {"symbol","consequence","hgvsp_short","transcript_id","refseq","hgvsc","impact","canonical",
+       "sift","sift_score","polyphen","polyphen_score","strand"},
+      {1,1,1,1,1,1,1,1,1,2,1,2,2}, "top_effect");
+    this->top_effect->use_extra_index = true; // priority of the chosen effect
+    this->emitted.push_back(this->top_effect);
   }
 
-  if(locate_and_test("consequence", 3, &_header, &_rules)){
-    auto consequence = main_table.separe_rows("consequence", "consequence", ';');
-    output_query.append(consequence->echo());
-    delete(consequence);
+  /* partitions: the derived tables also get the value of the partition column */
+  if(this->partition_column >= 0){
+    for(auto& table : this->tables){
+      table->partition_buckets = &this->partition_bucket_of;
+    }
+    for(auto table : this->emitted){
+      if(table != this->main_table) table->partition_keys = &this->partitions;
+    }
   }
 
-  if(locate_and_test("existing_variation", 3, &_header, &_rules)){
-    auto existing_variation = main_table.separe_rows("existing_variation", "existing_variation", ';');
-    output_query.append(existing_variation->echo());
-    delete(existing_variation);
+  /* summaries */
+  this->gene_sample_counts = this->classification_counts = this->impact_counts = this->filter_counts = NULL;
+  this->gene_column = this->column_position("hugo_symbol");
+  this->sample_column = this->column_position("tumor_sample_barcode");
+  this->classification_column = this->column_position("variant_classification");
+  this->filter_column = this->column_position("filter");
+  if(options.summaries){
+    if(this->gene_column >= 0 && this->sample_column >= 0){
+      this->counters.push_back(std::unique_ptr<value_counter>(
+        new value_counter("summary_gene_sample", {"hugo_symbol", "tumor_sample_barcode"})));
+      this->gene_sample_counts = this->counters.back().get();
+    }
+    if(this->classification_column >= 0){
+      this->counters.push_back(std::unique_ptr<value_counter>(
+        new value_counter("summary_variant_classification", {"variant_classification"})));
+      this->classification_counts = this->counters.back().get();
+    }
+    if(this->all_effects != NULL){
+      this->counters.push_back(std::unique_ptr<value_counter>(
+        new value_counter("summary_impact", {"impact"})));
+      this->impact_counts = this->counters.back().get();
+    }
+    if(this->filter_column >= 0){
+      this->counters.push_back(std::unique_ptr<value_counter>(
+        new value_counter("summary_filter", {"filter"})));
+      this->filter_counts = this->counters.back().get();
+    }
+  }
+}
+
+
+//' Position of a loaded column
+//'
+//' @param column name of the column
+//'
+//' @return its position in the main table, -1 if not loaded
+int maf_loader::column_position(std::string column){
+  auto pos_it = std::find(this->header.begin(), this->header.end(), column);
+  if(pos_it == this->header.end()) return -1;
+  return std::distance(this->header.begin(), pos_it);
+}
+
+
+//' Create a table owned by this loader
+//'
+//' @param header sequence of column names
+//' @param rules sequence of rules
+//' @param name table name
+//'
+//' @return the new table (deleted with the loader)
+text_table* maf_loader::add_table(std::vector<std::string> header, std::vector<int> rules, std::string name){
+  this->tables.push_back(std::unique_ptr<text_table>(new text_table(header, rules, name, -1)));
+  return this->tables.back().get();
+}
+
+
+//' Memory used by this loader
+//'
+//' @return allocated bytes (tables, buffers and text of the last chunk)
+size_t maf_loader::allocated_bytes(){
+  size_t bytes = sizeof(maf_loader) + this->tokens.capacity() * sizeof(field);
+  for(auto& query : this->queries){
+    bytes += sizeof(std::string) + query.capacity();
+  }
+  for(auto& table : this->tables){
+    bytes += table->allocated_bytes();
   }
+  for(auto& line : this->lines){
+    bytes += sizeof(std::string) + line.capacity();
+  }
+  for(auto& counter : this->counters){
+    bytes += counter->allocated_bytes();
+  }
+  return bytes;
+}
+
 
-  if(locate_and_test("refseq", 3, &_header, &_rules)){
-    auto refseq = main_table.separe_rows("refseq", "refseq", ';');
-    output_query.append(refseq->echo());
-    delete(refseq);
+//' Prepare queries to store a group of maf lines in a database
+//'
+//' Pure C++ part of maf_db_reader (it does not use the R API so that it
+//' can also run outside of the main thread, see AsyncLoader.cpp)
+//'
+//' @param _text group of maf lines (original text), the tables point to it
+//' @param starting_point starting index for "db_index" column (primary key)
+//' @param line_numbers line number of each line (for sampled lines, NULL
+//' when the lines are consecutive from starting_point)
+//'
+//' @return the necessary insertion queries to load MAF data into a database (one statement per string)
+//' (valid until the next call)
+const std::vector<std::string>& maf_loader::read(std::vector<std::string>& _text, int starting_point,
+                                                 const std::vector<int>* line_numbers){
+
+  for(auto& table : this->tables){
+    table->clear(-1);
   }
+  this->main_table->clear(starting_point);
+
+  // prepare main table
+  for(int i = 0; i<_text.size(); i++){
+    /* read it line by line */
+    field line_field = field(0,_text[i].length(), &(_text[i]));
+    if(this->options.filter.active() && !this->options.filter.accept(line_field)){
+      continue; // never tokenized nor expanded
+    }
 
-  if(locate_and_test("pubmed", 3, &_header, &_rules)){
-    auto pubmed = main_table.separe_rows("pubmed", "pubmed", ';');
-    output_query.append(pubmed->echo());
-    delete(pubmed);
+    int col_position = 0;
+    tokenize_selected(&line_field, '\t', &this->options.rules, this->tokens);
+    if(this->tokens.empty()){
+      continue; // no selected column in this line: no row
+    }
+    for(field& cell : this->tokens){
+      if(this->rules.at(col_position) == 1 || this->rules.at(col_position) == 3){ /* quote if necessary */
+        cell.quote();
+      }else if(!this->checks[col_position].empty() && !conforms(&cell, this->checks[col_position])){
+        cell = field(cell.begin(), cell.begin(), cell.source()); // not of its type: NULL
+      }
+      this->main_table->add(cell);
+      col_position++;
+    }
+    /* db_index is the line number, also for sampled or filtered lines (derived tables copy it) */
+    this->main_table->index.back() = (line_numbers != NULL ? line_numbers->at(i) : starting_point + i) + 1;
   }
 
-  if(locate_and_test("filter", 3, &_header, &_rules)){
-    auto filter = main_table.separe_rows("filter", "filter", ';');
-    output_query.append(filter->echo());
-    delete(filter);
+  if(this->partition_column >= 0){
+    this->assign_partitions();
   }
 
-  if(locate_and_test("gdc_filter", 3, &_header, &_rules)){
-    auto gdc_filter = main_table.separe_rows("gdc_filter", "gdc_filter", ';');
-    output_query.append(gdc_filter->echo());
-    delete(gdc_filter);
+  //--------------------------------------------------------------------------------
+
+  /* separe rows, manage lists */
+  for(auto& list : this->lists){
+    this->main_table->separe_rows(list.first, ';', *list.second);
   }
 
   /* domains */
-  if(locate_and_test("domains", 3, &_header, &_rules)){
-    auto domains = main_table.separe_rows("domains", "domains", ';');
-    auto domains_kv = domains->kv_separe("domains", 1, 1, "domains", ':');
-    output_query.append(domains_kv->echo());
-    delete(domains_kv);
-    delete(domains);
+  if(this->domains != NULL){
+    this->main_table->separe_rows("domains", ';', *this->domains);
+    this->domains->separe_cols("domains", ':', *this->domains_kv);
   }
 
   /* vcf_info */
-  if(locate_and_test("vcf_info", 3, &_header, &_rules)){
-    auto vcf_info = main_table.separe_rows("vcf_info", "vcf_info", ';');
-    auto vcf_info_kv = vcf_info->separe_vcf_info_field("vcf_info", 1, 1, "vcf_info", '=');
-    output_query.append(vcf_info_kv->echo());
-    delete(vcf_info_kv);
-    delete(vcf_info);
+  if(this->vcf_info_wide != NULL){
+    this->main_table->pivot_kv("vcf_info", this->options.vcf_info_types, ';', '=',
+                               *this->vcf_info_wide, *this->vcf_info_other);
+  }else if(this->vcf_info != NULL){
+    this->main_table->separe_rows("vcf_info", ';', *this->vcf_info);
+    this->vcf_info->separe_vcf_info_field("vcf_info", '=', *this->vcf_info_kv);
   }
 
-  /* kv_merge for tumor and normal genotypes */
-  if(locate_and_test("vcf_tumor_gt", 3, &_header, &_rules)){
-    auto vcf_tumor_gt = main_table.kv_merge("vcf_format", "vcf_tumor_gt", 1, 1, "vcf_tumor_gt", ':', ':');
-    output_query.append(vcf_tumor_gt->echo());
-    delete(vcf_tumor_gt);
+  /* kv_merge (or typed split) for tumor and normal genotypes */
+  if(this->vcf_tumor_gt != NULL && this->genotypes != NULL){
+    this->main_table->split_genotype("vcf_format", "vcf_tumor_gt", "tumor", *this->genotypes, *this->vcf_tumor_gt);
+  }else if(this->vcf_tumor_gt != NULL){
+    this->main_table->kv_merge("vcf_format", "vcf_tumor_gt", ':', ':', *this->vcf_tumor_gt);
   }
 
-  if(locate_and_test("vcf_normal_gt", 3, &_header, &_rules)){
-    auto vcf_normal_gt = main_table.kv_merge("vcf_format", "vcf_normal_gt", 1, 1, "vcf_normal_gt", ':', ':');
-    output_query.append(vcf_normal_gt->echo());
-    delete(vcf_normal_gt);
+  if(this->vcf_normal_gt != NULL && this->genotypes != NULL){
+    this->main_table->split_genotype("vcf_format", "vcf_normal_gt", "normal", *this->genotypes, *this->vcf_normal_gt);
+  }else if(this->vcf_normal_gt != NULL){
+    this->main_table->kv_merge("vcf_format", "vcf_normal_gt", ':', ':', *this->vcf_normal_gt);
   }
 
   /* --- VEP TABLE --- */
 
-  if(locate_and_test("all_effects", 3, &_header, &_rules)){
-    auto all_effects = main_table.separe_rows("all_effects", "all_effects", ';');
-    std::vector<std::string>* vep_header =
-      new std::vector<std::string>({"symbol","consequence","hgvsp_short","transcript_id",
-                                    "refseq","hgvsc","impact","canonical","sift","polyphen","strand"});
-    auto vep_rules = new std::vector<int>({1,1,1,1,1,1,1,1,0,0,2});
-    auto all_effects_table = all_effects->separe_cols("all_effects", vep_header, vep_rules, "all_effects", ',');
-    add_priority_index(all_effects_table);
-    output_query.append(all_effects_table->echo());
+  if(this->all_effects != NULL){
+    this->main_table->separe_rows("all_effects", ';', *this->all_effects);
+    this->all_effects->separe_cols("all_effects", ',', *this->all_effects_table);
+    add_priority_index(this->all_effects_table);
     // SIFT
-    auto sift_vep = all_effects_table->brackets_separe("sift", "sift_vep");
-    add_priority_index(sift_vep);
-    output_query.append(sift_vep->echo());
-    delete(sift_vep);
+    this->all_effects_table->separe_cols_brackets("sift", *this->sift_vep);
+    add_priority_index(this->sift_vep);
     // PolyPhen
-    auto polyphen = all_effects_table->brackets_separe("polyphen", "polyphen_vep");
-    add_priority_index(polyphen);
-    output_query.append(polyphen->echo());
-    delete(polyphen);
-    delete(all_effects_table);
-    delete(vep_header);
-    delete(vep_rules);
-    delete(all_effects);
+    this->all_effects_table->separe_cols_brackets("polyphen", *this->polyphen_vep);
+    add_priority_index(this->polyphen_vep);
+    if(this->top_effect != NULL){
+      this->select_top_effects();
+    }
+  }
+
+  this->update_summaries();
+
+  //--------------------------------------------------------------------------------
+
+  /* output */
+  this->queries.clear();
+  if(this->partition_column >= 0 && this->options.dialect != POSTGRESQL){
+    this->echo_partitions();
+  }else{ /* PostgreSQL routes the rows to their partition */
+    for(auto table : this->emitted){
+      table->echo(this->queries, this->options.dialect);
+    }
   }
 
   /* OUTPUT */
-  return wrap(output_query);
+  return this->queries;
+}
+
+
+//' Fill the top_effect table with the current chunk
+//'
+//' the effects of a variant are consecutive rows of all_effects_table (with
+//' their priority in extra_index), one of them is chosen by the policy in
+//' the options and its SIFT and PolyPhen fields are split in classification
+//' and score (NULL if not a number)
+void maf_loader::select_top_effects(){
+  text_table* effects = this->all_effects_table;
+  /* columns of all_effects_table (see the constructor) */
+  const int impact_column = effects->column("impact"), canonical_column = effects->column("canonical"),
+    sift_column = effects->column("sift"), polyphen_column = effects->column("polyphen"),
+    strand_column = effects->column("strand");
+  auto is = [](field* cell, const char* text){
+    int length = strlen(text);
+    if(cell->length() != length) return false;
+    for(int c = 0; c<length; c++){
+      if(toupper((unsigned char) cell->at(c)) != text[c]) return false;
+    }
+    return true;
+  };
+  auto severity = [&is](field* impact){
+    return is(impact, "HIGH") ? 4 : is(impact, "MODERATE") ? 3 : is(impact, "LOW") ? 2 : is(impact, "MODIFIER") ? 1 : 0;
+  };
+  /* columns copied as they are, in the order of the top_effect header */
+  std::vector<int> copied_columns;
+  for(std::string colname : {"symbol","consequence","hgvsp_short","transcript_id","refseq","hgvsc","impact","canonical"}){
+    copied_columns.push_back(effects->column(colname));
+  }
+
+  int new_row_pos = this->top_effect->nrow();
+  for(int first = 0; first<effects->nrow(); ){
+    int last = first;
+    while(last+1 < effects->nrow() && effects->index[last+1] == effects->index[first]) last++;
+
+    int best = first;
+    if(this->options.top_effect == TOP_EFFECT_CANONICAL){
+      for(int i = last; i>=first; i--){
+        if(is(effects->at(i, canonical_column), "YES")) best = i;
+      }
+    }else if(this->options.top_effect == TOP_EFFECT_SEVERE){
+      for(int i = first+1; i<=last; i++){
+        int difference = severity(effects->at(i, impact_column)) - severity(effects->at(best, impact_column));
+        if(difference > 0 || (difference == 0 && is(effects->at(i, canonical_column), "YES") &&
+                              !is(effects->at(best, canonical_column), "YES"))){
+          best = i;
+        }
+      }
+    }
+
+    for(int j : copied_columns){
+      this->top_effect->add(*effects->at(best, j));
+    }
+    for(int j : {sift_column, polyphen_column}){
+      field* prediction = effects->at(best, j);
+      tokenize_bracket(prediction, this->tokens);
+      if(this->tokens.size() == 0){ /* no score */
+        this->top_effect->add(*prediction);
+        this->top_effect->add(field(prediction->end(), prediction->end(), prediction->source()));
+      }else{
+        this->top_effect->add(this->tokens[0]);
+        this->top_effect->add(conforms(&this->tokens[1], "float") ?
+                              this->tokens[1] : field(prediction->end(), prediction->end(), prediction->source()));
+      }
+    }
+    this->top_effect->add(*effects->at(best, strand_column));
+    this->top_effect->index.at(new_row_pos) = effects->index.at(best);
+    this->top_effect->extra_index.at(new_row_pos) = effects->extra_index.at(best);
+    this->top_effect->partition.at(new_row_pos) = effects->partition.at(best);
+    new_row_pos++;
+
+    first = last+1;
+  }
+}
+
+
+//' Update the summaries with the current chunk
+//'
+//' impacts are counted on the first (priority) effect of each variant,
+//' filters are counted by element when filter is a list column
+void maf_loader::update_summaries(){
+  text_table* main = this->main_table;
+  for(int i = 0; i<main->nrow(); i++){
+    if(this->gene_sample_counts != NULL){
+      this->gene_sample_counts->count({main->at(i, this->gene_column), main->at(i, this->sample_column)});
+    }
+    if(this->classification_counts != NULL){
+      this->classification_counts->count({main->at(i, this->classification_column)});
+    }
+  }
+  if(this->impact_counts != NULL){
+    int impact_column = this->all_effects_table->column("impact");
+    for(int i = 0; i<this->all_effects_table->nrow(); i++){
+      if(this->all_effects_table->extra_index[i] != 1) continue;
+      this->impact_counts->count({this->all_effects_table->at(i, impact_column)});
+    }
+  }
+  if(this->filter_counts != NULL){
+    text_table* filters = main;
+    int column = this->filter_column;
+    for(auto& list : this->lists){
+      if(list.first == "filter"){ // one row per element
+        filters = list.second;
+        column = 0;
+      }
+    }
+    for(int i = 0; i<filters->nrow(); i++){
+      this->filter_counts->count({filters->at(i, column)});
+    }
+  }
+}
+
+
+//' Summary tables
+//'
+//' @return creation and insertion queries of the summary tables
+//' (counts of all the chunks read so far)
+std::vector<std::string> maf_loader::summaries(){
+  std::vector<std::string> out;
+  for(auto& counter : this->counters){
+    counter->echo(out, this->options.dialect);
+  }
+  return out;
+}
+
+
+//' Assign the rows of the main table to their partition
+//'
+//' new values are numbered as they are found and hashed to their
+//' bucket, the buckets of the current chunk are kept in chunk_partitions
+void maf_loader::assign_partitions(){
+  std::vector<bool> in_chunk(this->options.partition_buckets, false);
+  this->chunk_partitions.clear();
+  std::string value;
+  for(int i = 0; i<this->main_table->nrow(); i++){
+    field* cell = this->main_table->at(i, this->partition_column);
+    value.assign(*cell->source(), cell->begin(), cell->length());
+    auto hit = this->partition_ids.find(value);
+    int id;
+    if(hit == this->partition_ids.end()){ /* new value */
+      id = this->partitions.size();
+      this->partition_ids[value] = id;
+      this->partitions.push_back(value);
+      this->partition_bucket_of.push_back(partition_bucket(value, this->options.partition_buckets));
+    }else{
+      id = hit->second;
+    }
+    int bucket = this->partition_bucket_of[id];
+    if(!in_chunk[bucket]){
+      in_chunk[bucket] = true;
+      this->chunk_partitions.push_back(bucket);
+    }
+    this->main_table->partition[i] = id;
+  }
+  std::sort(this->chunk_partitions.begin(), this->chunk_partitions.end());
+}
+
+
+//' Prepare the insertion queries of each partition
+//'
+//' Partitions are printed in parallel (they are independent), the
+//' query contains all the tables of a partition before the next one.
+void maf_loader::echo_partitions(){
+  std::vector<std::vector<std::string>> outputs(this->chunk_partitions.size());
+  int n_threads = std::min<int>(outputs.size(), std::max<int>(std::thread::hardware_concurrency(), 1));
+  auto work = [this, &outputs, n_threads](int thread_id){
+    for(int k = thread_id; k<outputs.size(); k += n_threads){
+      for(auto table : this->emitted){
+        table->echo(outputs[k], this->options.dialect, this->chunk_partitions[k]);
+      }
+    }
+  };
+  std::vector<std::thread> workers;
+  for(int t = 1; t<n_threads; t++){
+    workers.push_back(std::thread(work, t));
+  }
+  if(n_threads > 0) work(0);
+  for(auto& worker : workers){
+    worker.join();
+  }
+  for(auto& output : outputs){
+    std::move(output.begin(), output.end(), std::back_inserter(this->queries));
+  }
 }
 
 
@@ -200,6 +748,21 @@ void add_priority_index(text_table* table){
    }
 }
 
+
+//' Policy of the top_effect table from its name
+//'
+//' @param name none, first, canonical or severe
+//'
+//' @return the TOP_EFFECT_* constant
+int top_effect_from_name(std::string name){
+  if(name == "none") return TOP_EFFECT_NONE;
+  if(name == "first") return TOP_EFFECT_FIRST;
+  if(name == "canonical") return TOP_EFFECT_CANONICAL;
+  if(name == "severe") return TOP_EFFECT_SEVERE;
+  stop("ERROR: unknown top effect policy " + name);
+  return TOP_EFFECT_NONE;
+}
+
 //' Test
 //'
 //' Simple testing procedure used for a small table and to show functionalities
@@ -212,7 +775,7 @@ void add_priority_index(text_table* table){
 //' @param starting_point starting index for "db_index" column (primary key)
 //'
 //' Function exported for R
-//' @return the necessary insertion query to load MAF data into a database
+//' @return the necessary insertion queries to load MAF data into a database (one statement per string)
 //' @export
 //[[Rcpp::export]]
 CharacterVector test_MAFdb(CharacterVector table_name, CharacterVector text, CharacterVector header,
@@ -225,58 +788,44 @@ CharacterVector test_MAFdb(CharacterVector table_name, CharacterVector text, Cha
   std::string _table_name = as<std::string>(table_name);
 
   /* main table */
-  text_table main_table = text_table(&_header, &_rules, _table_name, starting_point);
+  text_table main_table = text_table(_header, _rules, _table_name, starting_point);
 
   // prepare main table
+  std::vector<field> line_tok;
   for(int i = 0; i<_text.size(); i++){
     /* read it line by line */
-    field* line_field = new field(0,_text[i].length(), &(_text[i]));
+    field line_field = field(0,_text[i].length(), &(_text[i]));
 
     int col_position = 0;
-    auto line_tok = tokenize(line_field, '\t');
-    for(field* cell : *(line_tok) ){
+    tokenize(&line_field, '\t', line_tok);
+    for(field& cell : line_tok){
       if(_rules.at(col_position) == 1 || _rules.at(col_position) == 3){ /* quote if necessary */
-        cell->quote();
+        cell.quote();
       }
       main_table.add(cell);
       col_position++;
     }
-    /* cleanup */
-    delete(line_tok);
-    delete(line_field);
   }
 
   /* output */
-  std::string ouput_query = "";
-  ouput_query.append(main_table.echo());
-
-  auto splitted = main_table.separe_rows("list", "cosa", ';');
-
-  ouput_query.append(splitted->echo());
-
-  delete(splitted);
-
-  auto header_splitted_cols = new std::vector<std::string>();
-  header_splitted_cols->push_back("C1");
-  header_splitted_cols->push_back("C2");
-  auto rules_splitted_cols = new std::vector<int>();
-  rules_splitted_cols->push_back(1);
-  rules_splitted_cols->push_back(2);
-  auto splitted_cols = main_table.separe_cols("list_cols", header_splitted_cols, rules_splitted_cols,"nani", ';');
+  std::vector<std::string> ouput_query;
+  main_table.echo(ouput_query);
 
-  ouput_query.append(splitted_cols->echo());
+  text_table splitted = text_table({"list"}, {1}, "cosa", -1);
+  main_table.separe_rows("list", ';', splitted);
+  splitted.echo(ouput_query);
 
-  delete(splitted_cols);
-  delete(header_splitted_cols);
-  delete(rules_splitted_cols);
+  text_table splitted_cols = text_table({"C1","C2"}, {1,2}, "nani", -1);
+  main_table.separe_cols("list_cols", ';', splitted_cols);
+  splitted_cols.echo(ouput_query);
 
-  auto kv_test = main_table.kv_separe("kv_test", 1, 2, "kv1", '=');
-  ouput_query.append(kv_test->echo());
-  delete(kv_test);
+  text_table kv_test = text_table({"key","value"}, {1,2}, "kv1", -1);
+  main_table.separe_cols("kv_test", '=', kv_test);
+  kv_test.echo(ouput_query);
 
-  auto kv_test2 = main_table.kv_merge("keys", "values", 1, 2, "kv2", ':', ',');
-  ouput_query.append(kv_test2->echo());
-  delete(kv_test2);
+  text_table kv_test2 = text_table({"key","value"}, {1,2}, "kv2", -1);
+  main_table.kv_merge("keys", "values", ':', ',', kv_test2);
+  kv_test2.echo(ouput_query);
 
   /* OUTPUT */
   return wrap(ouput_query);
@@ -6,13 +6,94 @@
 #include <Rcpp.h>
 using namespace Rcpp;
 #include <strings.h>
+#include <iterator>
+#include <memory>
+#include <thread>
 
 #include "Table.h" 
 #include "Utils.h"
+#include "Summary.h"
+#include "Predicate.h"
+
+// how the top effect of a variant is chosen among its VEP effects
+
+const int TOP_EFFECT_NONE = 0; // no top_effect table
+const int TOP_EFFECT_FIRST = 1; // first effect (priority 1)
+const int TOP_EFFECT_CANONICAL = 2; // first canonical effect (or the first one)
+const int TOP_EFFECT_SEVERE = 3; // most severe impact (canonical first on ties)
+
+// structure of the MAF and loading options
+
+struct reader_options{
+  std::string table_name;
+  std::vector<std::string> header; // all the columns of the file
+  std::vector<int> rules;
+  std::vector<std::string> types; // type of each column (empty if unknown)
+  std::vector<std::string> vcf_info_keys; // wide vcf_info (empty for key/value)
+  std::vector<std::string> vcf_info_types;
+  int dialect = POSTGRESQL;
+  std::string partition_by; // partition column (empty for no partitions)
+  std::vector<std::string> partitions; // values of the existing partitions
+  int partition_buckets = 16; // number of partitions (values are hashed, see partition_bucket)
+  bool summaries = false; // count genes, classifications, impacts and filters
+  row_filter filter; // rejected lines are not tokenized (see Predicate.h)
+  bool typed_genotypes = false; // GT, DP and AD of the genotypes in a typed table
+  int top_effect = TOP_EFFECT_NONE; // policy of the top_effect table
+};
+
+// prepares the insertion queries of the chunks of a MAF file.
+// The loader owns the main table and all the sub-tables (created once
+// from the options), they are cleared between chunks keeping their
+// memory, so that a load of any length runs in constant memory.
+// When partitioned, the values of the partition column are hashed in a fixed
+// number of buckets: each row (and the rows derived from it, that also get
+// the value as last column) is written in the table of its bucket, or in the
+// parent table on PostgreSQL (that routes it to its hash partition).
+// Summaries (counts) are updated at each chunk and printed by summaries().
+
+class maf_loader{
+public:
+  maf_loader(reader_options options);
+  const std::vector<std::string>& read(std::vector<std::string>& text, int starting_point,
+                                       const std::vector<int>* line_numbers = NULL);
+  size_t allocated_bytes();
+  std::vector<std::string> lines; // text of the current chunk (see maf_loader_read)
+  std::vector<std::string> partitions; // partition values, in order of discovery
+  std::vector<std::string> summaries();
+private:
+  text_table* add_table(std::vector<std::string> header, std::vector<int> rules, std::string name);
+  void assign_partitions();
+  void echo_partitions();
+  void update_summaries();
+  void select_top_effects();
+  int column_position(std::string column);
+  reader_options options;
+  std::vector<std::string> header; // loaded columns
+  std::vector<int> rules;
+  std::vector<std::string> checks; // type tested on the values of unquoted columns ("" for none)
+  std::vector<field> tokens;
+  std::vector<std::string> queries; // statements of the current chunk
+  std::vector<std::unique_ptr<text_table>> tables; // owner of all the tables
+  std::vector<text_table*> emitted; // tables printed in the query (in order)
+  int partition_column; // -1 if not partitioned
+  std::unordered_map<std::string, int> partition_ids; // value -> position in partitions
+  std::vector<int> partition_bucket_of; // bucket of each value in partitions
+  std::vector<int> chunk_partitions; // buckets of the current chunk
+  text_table* main_table;
+  std::vector<std::pair<std::string, text_table*>> lists; // column -> rows table
+  text_table *domains, *domains_kv;
+  text_table *vcf_info, *vcf_info_kv, *vcf_info_wide, *vcf_info_other;
+  text_table *vcf_tumor_gt, *vcf_normal_gt, *genotypes;
+  text_table *all_effects, *all_effects_table, *sift_vep, *polyphen_vep, *top_effect;
+  std::vector<std::unique_ptr<value_counter>> counters; // owner of the summaries
+  value_counter *gene_sample_counts, *classification_counts, *impact_counts, *filter_counts;
+  int gene_column, sample_column, classification_column, filter_column;
+};
 
 CharacterVector maf_db_reader(CharacterVector table_name, CharacterVector text, CharacterVector header, 
-IntegerVector rules, int starting_point); 
-void separe_and_get_query(text_table& main_table, std::string& output_query, std::string colname, int rule);
+IntegerVector rules, int starting_point, CharacterVector vcf_info_keys, CharacterVector vcf_info_types,
+std::string dialect); 
 void add_priority_index(text_table* table);
+int top_effect_from_name(std::string name);
 
 #endif 
\ No newline at end of file
@@ -0,0 +1,259 @@
+#include "ResultCache.h"
+
+/* first bytes of a cached result (changes with the format) */
+const std::string CACHE_MAGIC = "MAFRC002";
+
+
+//' Map a file in memory
+//'
+//' @param path path of the file (good() is false if it cannot be read)
+mapped_file::mapped_file(std::string path){
+  this->begin = NULL;
+  this->length = 0;
+  this->mapped = false;
+#ifndef _WIN32
+  int fd = open(path.c_str(), O_RDONLY);
+  if(fd < 0) return;
+  struct stat info;
+  if(fstat(fd, &info) == 0 && info.st_size > 0){
+    void* address = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if(address != MAP_FAILED){
+      this->begin = (const char*) address;
+      this->length = info.st_size;
+      this->mapped = true;
+    }
+  }
+  ::close(fd); // the mapping stays valid
+#else
+  std::ifstream in(path, std::ios::binary);
+  if(!in.good()) return;
+  this->copy.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+  if(this->copy.size() > 0){
+    this->begin = this->copy.data();
+    this->length = this->copy.size();
+  }
+#endif
+}
+
+
+//' Destructor
+//'
+//' unmaps the file
+mapped_file::~mapped_file(){
+#ifndef _WIN32
+  if(this->mapped){
+    munmap((void*) this->begin, this->length);
+  }
+#endif
+}
+
+
+static void write_number(std::ofstream& out, long long value){
+  out.write((char*) &value, sizeof(value));
+}
+
+
+static void write_text(std::ofstream& out, const char* text, long long length){
+  write_number(out, length);
+  out.write(text, length);
+}
+
+
+//' Key of a cached result
+//'
+//' 64 bit FNV-1a hash of a text (e.g. a rendered SQL query)
+//'
+//' @param text the text
+//'
+//' @return the hash as 16 hexadecimal digits
+//[[Rcpp::export]]
+std::string result_cache_key(std::string text){
+  unsigned long long hash = 14695981039346656037ULL;
+  for(unsigned char c : text){
+    hash ^= c;
+    hash *= 1099511628211ULL;
+  }
+  char buffer[17];
+  snprintf(buffer, sizeof(buffer), "%016llx", hash);
+  return buffer;
+}
+
+
+//' Write a cached result
+//'
+//' Columnar binary file: for each column its type, name, attributes and
+//' values (4 or 8 bytes per value, strings as lengths and bytes). The file
+//' is written aside and then renamed, so readers never see partial files.
+//'
+//' @param path path of the cache file
+//' @param key text of the query (checked when reading, against hash collisions)
+//' @param columns a data frame (integer, double, logical and character columns,
+//' their attributes must be character vectors, e.g. class, tzone or units)
+//'
+//' @return written bytes (0 if a column cannot be cached)
+//[[Rcpp::export]]
+double result_cache_write(std::string path, std::string key, List columns){
+  SEXP names = Rf_getAttrib(columns, R_NamesSymbol);
+  int ncol = columns.size();
+  long long nrow = ncol > 0 ? Rf_xlength(VECTOR_ELT(columns, 0)) : 0;
+  for(int j = 0; j<ncol; j++){
+    SEXP column = VECTOR_ELT(columns, j);
+    int type = TYPEOF(column);
+    if((type != INTSXP && type != REALSXP && type != LGLSXP && type != STRSXP) ||
+       Rf_isFactor(column) || Rf_xlength(column) != nrow){
+      return 0;
+    }
+    for(SEXP attribute = ATTRIB(column); attribute != R_NilValue; attribute = CDR(attribute)){
+      if(TYPEOF(CAR(attribute)) != STRSXP) return 0;
+    }
+  }
+
+  std::string temporary = path + ".tmp";
+  std::ofstream out(temporary, std::ios::binary);
+  if(!out.good()){
+    stop("ERROR: cannot write " + temporary);
+  }
+  out.write(CACHE_MAGIC.data(), CACHE_MAGIC.size());
+  write_text(out, key.data(), key.size());
+  write_number(out, nrow);
+  write_number(out, ncol);
+  std::vector<long long> lengths;
+  for(int j = 0; j<ncol; j++){
+    SEXP column = VECTOR_ELT(columns, j);
+    write_number(out, TYPEOF(column));
+    const char* name = names == R_NilValue ? "" : Rf_translateCharUTF8(STRING_ELT(names, j));
+    write_text(out, name, strlen(name));
+    /* attributes (e.g. class, tzone of POSIXct, units of difftime): name and values */
+    write_number(out, Rf_length(ATTRIB(column)));
+    for(SEXP attribute = ATTRIB(column); attribute != R_NilValue; attribute = CDR(attribute)){
+      const char* attribute_name = CHAR(PRINTNAME(TAG(attribute)));
+      write_text(out, attribute_name, strlen(attribute_name));
+      SEXP values = CAR(attribute);
+      write_number(out, Rf_xlength(values));
+      for(long long k = 0; k<Rf_xlength(values); k++){
+        const char* value = STRING_ELT(values, k) == NA_STRING ? "" : Rf_translateCharUTF8(STRING_ELT(values, k));
+        write_text(out, value, strlen(value));
+      }
+    }
+
+    switch(TYPEOF(column)){
+      case INTSXP:
+        out.write((char*) INTEGER(column), nrow * sizeof(int));
+        break;
+      case LGLSXP:
+        out.write((char*) LOGICAL(column), nrow * sizeof(int));
+        break;
+      case REALSXP:
+        out.write((char*) REAL(column), nrow * sizeof(double));
+        break;
+      case STRSXP:
+        lengths.resize(nrow);
+        for(long long i = 0; i<nrow; i++){
+          SEXP value = STRING_ELT(column, i);
+          lengths[i] = value == NA_STRING ? -1 : strlen(Rf_translateCharUTF8(value));
+        }
+        out.write((char*) lengths.data(), nrow * sizeof(long long));
+        for(long long i = 0; i<nrow; i++){
+          if(lengths[i] > 0) out.write(Rf_translateCharUTF8(STRING_ELT(column, i)), lengths[i]);
+        }
+        break;
+    }
+  }
+  double bytes = out.tellp();
+  out.close();
+  if(!out.good() || std::rename(temporary.c_str(), path.c_str()) != 0){
+    std::remove(temporary.c_str());
+    return 0;
+  }
+  return bytes;
+}
+
+
+//' Read a cached result
+//'
+//' The file is memory mapped, numeric columns are copied directly from it.
+//'
+//' @param path path of the cache file
+//' @param key text of the query
+//'
+//' @return a list of columns (NULL if the file is missing, invalid or of another query)
+//[[Rcpp::export]]
+SEXP result_cache_read(std::string path, std::string key){
+  mapped_file file(path);
+  if(!file.good()) return R_NilValue;
+  cache_cursor cursor(file.data(), file.size());
+
+  const char* magic;
+  std::string cached_key;
+  long long nrow, ncol;
+  if(!cursor.take(CACHE_MAGIC.size(), magic) || CACHE_MAGIC.compare(0, CACHE_MAGIC.size(), magic, CACHE_MAGIC.size()) != 0 ||
+     !cursor.text(cached_key) || cached_key != key ||
+     !cursor.number(nrow) || !cursor.number(ncol) || nrow < 0 || ncol < 0){
+    return R_NilValue;
+  }
+
+  SEXP columns = PROTECT(Rf_allocVector(VECSXP, ncol));
+  SEXP names = PROTECT(Rf_allocVector(STRSXP, ncol));
+  std::string name, attribute_name, attribute_value;
+  std::vector<std::pair<std::string, std::vector<std::string>>> attributes;
+  bool valid = true;
+  for(long long j = 0; valid && j<ncol; j++){
+    long long type, n_attributes;
+    const char* values;
+    valid = cursor.number(type) && cursor.text(name) && cursor.number(n_attributes) && n_attributes >= 0;
+    attributes.clear();
+    for(long long k = 0; valid && k<n_attributes; k++){
+      long long n_values;
+      valid = cursor.text(attribute_name) && cursor.number(n_values) && n_values >= 0;
+      attributes.push_back({attribute_name, {}});
+      for(long long v = 0; valid && v<n_values; v++){
+        valid = cursor.text(attribute_value);
+        attributes.back().second.push_back(attribute_value);
+      }
+    }
+    if(!valid) break;
+    SET_STRING_ELT(names, j, Rf_mkCharLenCE(name.data(), name.size(), CE_UTF8));
+    SEXP column = R_NilValue;
+    if(type == INTSXP || type == LGLSXP){
+      valid = cursor.take(nrow * sizeof(int), values);
+      if(!valid) break;
+      column = Rf_allocVector(type, nrow);
+      SET_VECTOR_ELT(columns, j, column);
+      memcpy(type == INTSXP ? INTEGER(column) : LOGICAL(column), values, nrow * sizeof(int));
+    }else if(type == REALSXP){
+      valid = cursor.take(nrow * sizeof(double), values);
+      if(!valid) break;
+      column = Rf_allocVector(REALSXP, nrow);
+      SET_VECTOR_ELT(columns, j, column);
+      memcpy(REAL(column), values, nrow * sizeof(double));
+    }else if(type == STRSXP){
+      const char* lengths;
+      valid = cursor.take(nrow * sizeof(long long), lengths);
+      if(!valid) break;
+      column = Rf_allocVector(STRSXP, nrow);
+      SET_VECTOR_ELT(columns, j, column);
+      for(long long i = 0; valid && i<nrow; i++){
+        long long length;
+        memcpy(&length, lengths + i * sizeof(long long), sizeof(length));
+        if(length < 0){
+          SET_STRING_ELT(column, i, NA_STRING);
+        }else{
+          valid = cursor.take(length, values);
+          if(valid) SET_STRING_ELT(column, i, Rf_mkCharLenCE(values, length, CE_UTF8));
+        }
+      }
+    }else{
+      valid = false;
+    }
+    for(size_t k = 0; valid && k<attributes.size(); k++){
+      Rf_setAttrib(column, Rf_install(attributes[k].first.c_str()), wrap(attributes[k].second));
+    }
+  }
+  if(!valid){
+    UNPROTECT(2);
+    return R_NilValue;
+  }
+  Rf_setAttrib(columns, R_NamesSymbol, names);
+  UNPROTECT(2);
+  return columns;
+}
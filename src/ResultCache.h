@@ -0,0 +1,63 @@
+// ResultCache.h
+
+#ifndef MAF_READER_RESULT_CACHE
+#define MAF_READER_RESULT_CACHE
+
+#include <Rcpp.h>
+#include <fstream>
+#include <cstdio>
+#include <cstring>
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+using namespace Rcpp;
+
+// read only view of a file: memory mapped (a copy in memory on Windows)
+
+class mapped_file{
+public:
+  mapped_file(std::string path);
+  ~mapped_file();
+  const char* data(){return this->begin;}
+  size_t size(){return this->length;}
+  bool good(){return this->begin != NULL;}
+private:
+  const char* begin;
+  size_t length;
+  bool mapped;
+  std::string copy;
+};
+
+// sequential (bounds checked) reader of a cached result
+
+class cache_cursor{
+public:
+  cache_cursor(const char* begin, size_t length){this->position = begin; this->end = begin + length;}
+  bool take(size_t bytes, const char*& out){
+    if(bytes > (size_t) (this->end - this->position)) return false;
+    out = this->position;
+    this->position += bytes;
+    return true;
+  }
+  bool number(long long& out){
+    const char* bytes;
+    if(!this->take(sizeof(out), bytes)) return false;
+    memcpy(&out, bytes, sizeof(out));
+    return true;
+  }
+  bool text(std::string& out){
+    long long length;
+    const char* bytes;
+    if(!this->number(length) || length < 0 || !this->take(length, bytes)) return false;
+    out.assign(bytes, length);
+    return true;
+  }
+private:
+  const char* position;
+  const char* end;
+};
+
+#endif
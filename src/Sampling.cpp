@@ -0,0 +1,125 @@
+#include "Sampling.h"
+
+
+//' Reservoir constructor
+//'
+//' @param size number of lines of the sample
+reservoir::reservoir(int size){
+  this->size = std::max(size, 0);
+  this->seen = 0;
+}
+
+
+//' Offer a line to the sample
+//'
+//' the i-th line replaces a random element of a full
+//' reservoir with probability size/i
+//'
+//' @param line the line
+//' @param line_number its position in the file
+//' @param rng random number generator
+void reservoir::offer(const std::string& line, long long line_number, std::mt19937_64& rng){
+  this->seen++;
+  if(this->lines.size() < this->size){
+    this->lines.push_back(line);
+    this->line_numbers.push_back(line_number);
+    return;
+  }
+  long long slot = std::uniform_int_distribution<long long>(0, this->seen - 1)(rng);
+  if(slot < this->size){
+    this->lines[slot].assign(line); // reuses the memory of the replaced line
+    this->line_numbers[slot] = line_number;
+  }
+}
+
+
+//' Sample the lines of a MAF file
+//'
+//' One pass on the file, keeping at most `size` lines (per stratum when
+//' `strata` is a column of the file): a uniform (reservoir) sample or a
+//' stratified sample with a reservoir for each value of the column.
+//'
+//' @param path path to the MAF file
+//' @param size number of lines of the sample (of each stratum)
+//' @param strata name of the stratification column (empty for a uniform sample)
+//' @param seed seed of the random number generator
+//'
+//' @return a list with the sampled lines and their line numbers (0 is the
+//' first line after the header), in the order of the file
+//[[Rcpp::export]]
+List maf_sample(std::string path, int size, std::string strata, double seed){
+  std::ifstream in(path, std::ios::binary);
+  if(!in.good()){
+    stop("ERROR: cannot open " + path);
+  }
+
+  /* header (skip comments) */
+  std::string line;
+  while(std::getline(in, line)){
+    if(line != "" && line[0] != '#') break;
+  }
+  if(line.size() > 0 && line.back() == '\r') line.pop_back();
+  std::transform(line.begin(), line.end(), line.begin(), ::tolower);
+  int strata_column = -1;
+  int col = 0;
+  for(int cursor = 0, ini = 0; cursor <= line.size(); cursor++){
+    if(cursor == line.size() || line[cursor] == '\t'){
+      if(strata != "" && line.compare(ini, cursor - ini, strata) == 0) strata_column = col;
+      ini = cursor + 1;
+      col++;
+    }
+  }
+  if(strata != "" && strata_column < 0){
+    stop("ERROR: cannot sample by " + strata + ", column not found");
+  }
+
+  std::mt19937_64 rng((unsigned long long) seed);
+  std::unordered_map<std::string, reservoir> reservoirs; // stratum -> sample
+  std::string stratum;
+  long long line_number = 0;
+  while(std::getline(in, line)){
+    if(line.size() > 0 && line.back() == '\r') line.pop_back(); // as readLines
+    if(strata_column >= 0){
+      /* value of the stratification column */
+      int ini = 0;
+      col = 0;
+      stratum.clear();
+      for(int cursor = 0; cursor <= line.size(); cursor++){
+        if(cursor == line.size() || line[cursor] == '\t'){
+          if(col == strata_column){
+            stratum.assign(line, ini, cursor - ini);
+            break;
+          }
+          ini = cursor + 1;
+          col++;
+        }
+      }
+    }
+    auto hit = reservoirs.find(stratum);
+    if(hit == reservoirs.end()){
+      hit = reservoirs.emplace(stratum, reservoir(size)).first;
+    }
+    hit->second.offer(line, line_number, rng);
+    line_number++;
+    if(line_number % 1000000 == 0) checkUserInterrupt();
+  }
+
+  /* merge the strata in the order of the file */
+  std::vector<std::pair<long long, std::string*>> sampled;
+  for(auto& entry : reservoirs){
+    for(int i = 0; i<entry.second.lines.size(); i++){
+      sampled.push_back(std::make_pair(entry.second.line_numbers[i], &entry.second.lines[i]));
+    }
+  }
+  std::sort(sampled.begin(), sampled.end());
+  std::vector<std::string> lines(sampled.size());
+  std::vector<double> line_numbers(sampled.size());
+  for(int i = 0; i<sampled.size(); i++){
+    line_numbers[i] = sampled[i].first;
+    lines[i].swap(*sampled[i].second);
+  }
+  return List::create(
+    Named("lines") = lines,
+    Named("line_numbers") = line_numbers
+  );
+}
@@ -0,0 +1,26 @@
+// Sampling.h
+
+#ifndef MAF_READER_SAMPLING
+#define MAF_READER_SAMPLING
+
+#include <Rcpp.h>
+#include <fstream>
+#include <random>
+#include <unordered_map>
+using namespace Rcpp;
+
+// uniform sample of fixed size of a stream of lines (algorithm R),
+// the line number of each sampled line is kept
+
+class reservoir{
+public:
+  reservoir(int size);
+  void offer(const std::string& line, long long line_number, std::mt19937_64& rng);
+  std::vector<std::string> lines;
+  std::vector<long long> line_numbers;
+private:
+  int size;
+  long long seen;
+};
+
+#endif
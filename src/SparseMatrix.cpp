@@ -0,0 +1,224 @@
+#include "SparseMatrix.h"
+
+/* code of the cells with more than one classification */
+const std::string MULTI_HIT = "Multi_Hit";
+
+
+//' Interned id of a string
+//'
+//' @param value the string
+//'
+//' @return its id (new strings get the next one)
+int string_interner::id(const std::string& value){
+  auto hit = this->ids.find(value);
+  if(hit != this->ids.end()) return hit->second;
+  int new_id = this->values.size();
+  this->ids[value] = new_id;
+  this->values.push_back(value);
+  return new_id;
+}
+
+
+//' Matrix builder constructor
+//'
+//' @param values MATRIX_COUNTS (number of mutations) or MATRIX_CLASSIFICATIONS
+//' (code of the variant classification, Multi_Hit when they differ)
+//' @param classifications accepted variant classifications (empty for all)
+//' @param filters accepted filters (empty for all)
+matrix_builder::matrix_builder(int values, std::vector<std::string> classifications, std::vector<std::string> filters){
+  this->values = values;
+  this->classifications.insert(classifications.begin(), classifications.end());
+  this->filters.insert(filters.begin(), filters.end());
+}
+
+
+//' Test the filters on a mutation
+//'
+//' a filter list (e.g. "common_variant;ndp") is accepted only if
+//' all its elements are accepted
+//'
+//' @param classification variant classification
+//' @param filter filter field (NULL if not available)
+//'
+//' @return true if the mutation should be counted
+bool matrix_builder::accepted(const std::string& classification, field* filter){
+  if(!this->classifications.empty() && this->classifications.count(classification) == 0){
+    return false;
+  }
+  if(!this->filters.empty() && filter != NULL){
+    tokenize(filter, ';', this->tokens);
+    for(auto& element : this->tokens){
+      this->token.assign(*element.source(), element.begin(), element.length());
+      if(this->filters.count(this->token) == 0) return false;
+    }
+  }
+  return true;
+}
+
+
+//' Add a mutation
+//'
+//' @param gene hugo symbol
+//' @param sample tumor sample barcode
+//' @param classification variant classification
+//' @param filter filter field (NULL if not available)
+void matrix_builder::add(const std::string& gene, const std::string& sample,
+                         const std::string& classification, field* filter){
+  if(!this->accepted(classification, filter)) return;
+  long long key = ((long long) this->samples.id(sample) << 32) | this->genes.id(gene);
+  if(this->values == MATRIX_COUNTS){
+    this->cells[key]++;
+  }else{
+    double code = this->codes.id(classification) + 1; // 0 is not stored
+    auto hit = this->cells.find(key);
+    if(hit == this->cells.end()){
+      this->cells[key] = code;
+    }else if(hit->second != code){
+      hit->second = this->codes.id(MULTI_HIT) + 1;
+    }
+  }
+}
+
+
+//' Compressed sparse column matrix
+//'
+//' @return a list with i (0 based rows), p (column pointers), x, Dim,
+//' Dimnames (genes, samples) and levels (of the classification codes)
+List matrix_builder::result(){
+  std::vector<std::pair<long long, double>> entries(this->cells.begin(), this->cells.end());
+  std::sort(entries.begin(), entries.end()); // by sample, then gene
+  int n_samples = this->samples.values.size();
+  std::vector<int> i(entries.size());
+  std::vector<double> x(entries.size());
+  std::vector<int> p(n_samples + 1, 0);
+  for(int k = 0; k<entries.size(); k++){
+    i[k] = entries[k].first & 0xFFFFFFFF;
+    x[k] = entries[k].second;
+    p[(entries[k].first >> 32) + 1]++;
+  }
+  for(int j = 0; j<n_samples; j++){
+    p[j+1] += p[j];
+  }
+  return List::create(
+    Named("i") = i,
+    Named("p") = p,
+    Named("x") = x,
+    Named("Dim") = IntegerVector::create(this->genes.values.size(), n_samples),
+    Named("Dimnames") = List::create(this->genes.values, this->samples.values),
+    Named("levels") = this->codes.values
+  );
+}
+
+
+//' Create a sparse matrix builder
+//'
+//' @param values "count" or "classification"
+//' @param classifications accepted variant classifications (empty for all)
+//' @param filters accepted filters (empty for all)
+//'
+//' @return an handle to the builder
+//[[Rcpp::export]]
+SEXP matrix_builder_create(std::string values, std::vector<std::string> classifications,
+                           std::vector<std::string> filters){
+  int mode = values == "classification" ? MATRIX_CLASSIFICATIONS : MATRIX_COUNTS;
+  return XPtr<matrix_builder>(new matrix_builder(mode, classifications, filters), true);
+}
+
+
+//' Add a group of mutations to a sparse matrix builder
+//'
+//' @param builder handle returned by matrix_builder_create
+//' @param genes hugo symbols
+//' @param samples tumor sample barcodes
+//' @param classifications variant classifications
+//' @param filters filters (empty if not available)
+//[[Rcpp::export]]
+void matrix_builder_add(SEXP builder, std::vector<std::string> genes, std::vector<std::string> samples,
+                        std::vector<std::string> classifications, std::vector<std::string> filters){
+  XPtr<matrix_builder> ptr(builder);
+  for(int k = 0; k<genes.size(); k++){
+    if(filters.size() > 0){
+      field filter = field(0, filters[k].size(), &filters[k]);
+      ptr->add(genes[k], samples[k], classifications[k], &filter);
+    }else{
+      ptr->add(genes[k], samples[k], classifications[k], NULL);
+    }
+  }
+}
+
+
+//' Result of a sparse matrix builder
+//'
+//' @param builder handle returned by matrix_builder_create
+//'
+//' @return see matrix_builder::result
+//[[Rcpp::export]]
+List matrix_builder_result(SEXP builder){
+  XPtr<matrix_builder> ptr(builder);
+  return ptr->result();
+}
+
+
+//' Build a sparse matrix from a MAF file
+//'
+//' The file is read once, only the needed columns are tokenized
+//'
+//' @param path path to the MAF file
+//' @param values "count" or "classification"
+//' @param classifications accepted variant classifications (empty for all)
+//' @param filters accepted filters (empty for all)
+//'
+//' @return see matrix_builder::result
+//[[Rcpp::export]]
+List matrix_from_maf(std::string path, std::string values, std::vector<std::string> classifications,
+                     std::vector<std::string> filters){
+  std::ifstream in(path, std::ios::binary);
+  if(!in.good()){
+    stop("ERROR: cannot open " + path);
+  }
+
+  /* header (skip comments) */
+  std::string line;
+  while(std::getline(in, line)){
+    if(line != "" && line[0] != '#') break;
+  }
+  if(line.size() > 0 && line.back() == '\r') line.pop_back();
+  std::transform(line.begin(), line.end(), line.begin(), ::tolower);
+  field header_field = field(0, line.size(), &line);
+  std::vector<field> header;
+  tokenize(&header_field, '\t', header);
+
+  /* needed columns */
+  std::vector<std::string> needed = {"hugo_symbol", "tumor_sample_barcode", "variant_classification", "filter"};
+  std::vector<int> rules(header.size(), 0); /* 0: not tokenized */
+  std::vector<int> slot(needed.size(), -1); /* position among the tokenized fields */
+  int position = 0;
+  for(int j = 0; j<header.size(); j++){
+    auto pos_it = std::find(needed.begin(), needed.end(), line.substr(header[j].begin(), header[j].length()));
+    if(pos_it != needed.end()){
+      rules[j] = 1;
+      slot[std::distance(needed.begin(), pos_it)] = position++;
+    }
+  }
+  for(int k = 0; k<3; k++){
+    if(slot[k] < 0) stop("ERROR: column " + needed[k] + " not found");
+  }
+
+  matrix_builder builder = matrix_builder(values == "classification" ? MATRIX_CLASSIFICATIONS : MATRIX_COUNTS,
+                                          classifications, filters);
+  std::vector<field> tokens;
+  std::string gene, sample, classification;
+  int line_number = 0;
+  while(std::getline(in, line)){
+    if(line.size() > 0 && line.back() == '\r') line.pop_back();
+    if(line == "") continue;
+    field line_field = field(0, line.size(), &line);
+    tokenize_selected(&line_field, '\t', &rules, tokens);
+    gene.assign(line, tokens[slot[0]].begin(), tokens[slot[0]].length());
+    sample.assign(line, tokens[slot[1]].begin(), tokens[slot[1]].length());
+    classification.assign(line, tokens[slot[2]].begin(), tokens[slot[2]].length());
+    builder.add(gene, sample, classification, slot[3] >= 0 ? &tokens[slot[3]] : NULL);
+    if(++line_number % 100000 == 0) checkUserInterrupt();
+  }
+  return builder.result();
+}
@@ -0,0 +1,49 @@
+// SparseMatrix.h
+
+#ifndef MAF_READER_SPARSE_MATRIX
+#define MAF_READER_SPARSE_MATRIX
+
+#include <Rcpp.h>
+#include <fstream>
+#include <unordered_map>
+#include <unordered_set>
+using namespace Rcpp;
+
+#include "Field.h"
+#include "Utils.h"
+
+/* values of the matrix */
+const int MATRIX_COUNTS = 0;
+const int MATRIX_CLASSIFICATIONS = 1;
+
+// strings to consecutive integers
+
+class string_interner{
+public:
+  int id(const std::string& value);
+  std::vector<std::string> values;
+private:
+  std::unordered_map<std::string, int> ids;
+};
+
+// builds a gene x sample sparse matrix from a stream of mutations,
+// the result is in compressed sparse column format (dgCMatrix)
+
+class matrix_builder{
+public:
+  matrix_builder(int values, std::vector<std::string> classifications, std::vector<std::string> filters);
+  void add(const std::string& gene, const std::string& sample,
+           const std::string& classification, field* filter);
+  List result();
+private:
+  bool accepted(const std::string& classification, field* filter);
+  int values;
+  std::unordered_set<std::string> classifications; // empty: all accepted
+  std::unordered_set<std::string> filters; // empty: all accepted
+  string_interner genes, samples, codes;
+  std::unordered_map<long long, double> cells; // (sample, gene) -> value
+  std::vector<field> tokens;
+  std::string token; // reused buffer
+};
+
+#endif
@@ -0,0 +1,94 @@
+#include "Summary.h"
+
+
+//' Value counter constructor
+//'
+//' @param name name of the summary table
+//' @param header names of the counted columns (the count is "n")
+value_counter::value_counter(std::string name, std::vector<std::string> header){
+  this->name = name;
+  this->header = header;
+}
+
+
+//' Count a row
+//'
+//' values are joined by tabs (that cannot be part of a MAF field)
+//'
+//' @param values values of the counted columns
+void value_counter::count(std::initializer_list<field*> values){
+  this->key.clear();
+  bool first = true;
+  for(field* value : values){
+    if(!first) this->key.push_back('\t');
+    this->key.append(*value->source(), value->begin(), value->length());
+    first = false;
+  }
+  this->counts[this->key]++; // the key is copied only when new
+}
+
+
+//' Prepare creation and insertion query of the summary table
+//'
+//' the table is created if it does not exist, empty values are NULL.
+//' The counts are added to the rows already in the table (e.g. of a
+//' previous load): the table is rewritten with the sum of each group.
+//'
+//' @param out the statements are appended here
+//' @param dialect POSTGRESQL, SQLITE or DUCKDB
+void value_counter::echo(std::vector<std::string>& out, int dialect){
+  std::string columns = ""; // counted columns, comma separated
+  for(auto& column : this->header){
+    if(columns != "") columns.append(", ");
+    columns.append(column);
+  }
+  std::string create = "CREATE TABLE IF NOT EXISTS " + this->name + " (";
+  for(auto& column : this->header){
+    create.append(column + " varchar, ");
+  }
+  create.append("n bigint);\n");
+  out.push_back(create);
+
+  /* the fields of the table point to these strings */
+  std::deque<std::string> text;
+  std::vector<std::string> table_header = this->header;
+  table_header.push_back("n");
+  std::vector<int> table_rules(this->header.size(), 1);
+  table_rules.push_back(2);
+  text_table table = text_table(table_header, table_rules, this->name, -1);
+  table.use_index = false;
+  std::vector<field> tokens;
+  for(auto& entry : this->counts){
+    text.push_back(entry.first);
+    field key = field(0, text.back().size(), &text.back());
+    tokenize(&key, '\t', tokens);
+    for(auto& value : tokens){
+      table.add(value);
+    }
+    text.push_back(std::to_string((long long) entry.second));
+    table.add(field(0, text.back().size(), &text.back()));
+  }
+  if(table.nrow() == 0) return;
+  table.echo(out, dialect);
+
+  /* merge with the counts already stored (GROUP BY puts NULLs together) */
+  std::string merged = this->name + "_merged";
+  out.push_back("CREATE TEMPORARY TABLE " + merged + " AS SELECT " + columns + ", SUM(n) AS n FROM " +
+                this->name + " GROUP BY " + columns + ";\n");
+  out.push_back("DELETE FROM " + this->name + ";\n");
+  out.push_back("INSERT INTO " + this->name + " SELECT " + columns + ", n FROM " + merged + ";\n");
+  out.push_back("DROP TABLE " + merged + ";\n");
+}
+
+
+//' Memory used by the counter
+//'
+//' @return allocated bytes (approximated for the hash map nodes)
+size_t value_counter::allocated_bytes(){
+  size_t bytes = sizeof(value_counter) + this->key.capacity() +
+    this->counts.bucket_count() * sizeof(void*);
+  for(auto& entry : this->counts){
+    bytes += sizeof(entry) + sizeof(void*) + entry.first.capacity();
+  }
+  return bytes;
+}
@@ -0,0 +1,29 @@
+// Summary.h
+
+#ifndef MAF_READER_SUMMARY
+#define MAF_READER_SUMMARY
+
+#include <Rcpp.h>
+#include <deque>
+#include <unordered_map>
+using namespace Rcpp;
+
+#include "Table.h"
+
+// counts the rows of each distinct combination of values,
+// updated chunk by chunk and printed as a small summary table
+
+class value_counter{
+public:
+  value_counter(std::string name, std::vector<std::string> header);
+  void count(std::initializer_list<field*> values);
+  void echo(std::vector<std::string>& out, int dialect);
+  size_t allocated_bytes();
+  std::string name;
+private:
+  std::vector<std::string> header;
+  std::unordered_map<std::string, double> counts;
+  std::string key; // reused buffer
+};
+
+#endif
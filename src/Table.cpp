@@ -5,6 +5,7 @@
  * 0: mask column (do not report in ouput query)
  * 1: quote
  * 2: do not quote
+ * 4: boolean (literal of the dialect)
  */
 
 
@@ -18,17 +19,18 @@
 //' @param rules sequence of rules (quoting etc.)
 //' @param name table name
 //' @param starting_point starting index (-1) for the db_index additional column
-text_table::text_table(std::vector<std::string>* header, std::vector<int>* rules, std::string name, int starting_point){
-  assert(header->size() == rules->size());
+text_table::text_table(std::vector<std::string> header, std::vector<int> rules, std::string name, int starting_point){
+  assert(header.size() == rules.size());
   this->header = header; // table header used to locate columns by name
   this->rules = rules; // output rules for each column
-  this->content = new std::vector<std::vector<field*>*>(); // content of the table
+  this->content = std::vector<field>(); // content of the table (row major)
   this->line = -1; // -1 means that no line currently exist
   this->col = 0; // pointer to the current column in field insertion
   this->name = name; // name of this table for the output query
   this->starting_point = starting_point;
   this->index = std::vector<int>(); // db_index
   this->extra_index = std::vector<int>(); // extra index for other uses
+  this->partition = std::vector<int>(); // partition of the rows
   this->use_extra_index = false; // true if output should include extra index
 }
 
@@ -39,10 +41,9 @@ text_table::text_table(std::vector<std::string>* header, std::vector<int>* rules
 //' the extra_index for the user.
 //'
 //' @param next field to be added
-void text_table::add(field* next){
-  if(this->content->size() == 0 || this->content->at(this->line)->size() >= this->ncol()){
+void text_table::add(field next){
+  if(this->line == -1 || this->col >= this->ncol()){
     // manage new line
-    this->content->push_back(new std::vector<field*>());
     this->col = 0;
     this->line++;
   }
@@ -55,94 +56,89 @@ void text_table::add(field* next){
       this->index.push_back(0); // something else will set the indexes
       this->extra_index.push_back(0);
     }
+    this->partition.push_back(0);
   }
   // add field
-  this->content->at(this->line)->push_back(next);
+  this->content.push_back(next);
   /* apply quoting rules */
-  if(this->rules->at(this->col) == 1){
-    this->content->at(this->line)->at(this->col)->quote();
-  }else if(this->rules->at(this->col) == 2){
-    this->content->at(this->line)->at(this->col)->unquote();
+  if(this->rules[this->col] == 1){
+    this->content.back().quote();
+  }else if(this->rules[this->col] == 2){
+    this->content.back().unquote();
+  }else if(this->rules[this->col] == 4){
+    this->content.back().boolean();
   }
   this->col++;
 }
 
 
-//' Destructor
+//' Empty the table
 //'
-//' The destructor deletes all the content of "content"
+//' The content is removed but the allocated memory is kept
+//' to be reused by the next chunk
 //'
-text_table::~text_table(){
-  for(int i = 0; i<this->nrow(); i++){
-    for(int j = 0; j<this->ncol(); j++){
-      delete(this->content->at(i)->at(j));
-    }
-    delete(this->content->at(i));
-  }
-  delete(this->content);
+//' @param starting_point new starting index (-1) for the db_index column
+void text_table::clear(int starting_point){
+  this->content.clear();
+  this->index.clear();
+  this->extra_index.clear();
+  this->partition.clear();
+  this->generated.clear();
+  this->line = -1;
+  this->col = 0;
+  this->starting_point = starting_point;
 }
 
 
-
-//' Prepare insertion query
+//' Position of a column
 //'
-//' --- The query was tested for PostgeSQL ---
+//' @param colname name of the column
 //'
-//' db_index is the first column while the auxiliary index
-//' is the second column (when used).
-//'
-//' Quoting is managed filed per field
-//'
-//' @return insertion query for this table
-std::string text_table::echo(){
-  if(content->size() == 0) return ""; /* empty table */
-  std::string out = "INSERT INTO ";
-  out.append(this->name);
-
-  out.append(" VALUES \n");
-  for(int i = 0; i<this->nrow(); i++){
-    out.push_back('(');
-    out.append(std::to_string(this->index.at(i))); // add DB_INDEX
-    out.push_back(',');
-    if(this->use_extra_index){
-      out.append(std::to_string(this->extra_index.at(i))); // add EXTRA_INDEX
-      out.push_back(',');
-    }
-    for(int j = 0; j<this->ncol(); j++){
-      if(this->rules->at(j) == 0) continue; // skip masked (rule 0) columns
-      out.append(this->content->at(i)->at(j)->echo());
-      if(j+1!=this->ncol()){ // not last column
-        out.push_back(',');
-      }
-    }
-    out.push_back(')');
-    if(i+1 == this->nrow()){ // last line
-      out.push_back(';');
-      out.push_back('\n');
-    }else{
-      out.push_back(',');
-    }
-  }
-  return out;
+//' @return its position in the header (-1 if missing)
+int text_table::column(std::string colname){
+  auto pos_it = std::find(this->header.begin(), this->header.end(), colname);
+  if(pos_it == this->header.end()) return -1;
+  return std::distance(this->header.begin(), pos_it);
 }
 
 
-//' Access field
-//'
-//' Get field at given position
+//' Memory used by the table
 //'
-//' @param row
-//' @param col
+//' @return allocated bytes (fields, indexes and buffers, not the text)
+size_t text_table::allocated_bytes(){
+  return sizeof(text_table) +
+    (this->content.capacity() + this->tokens.capacity() + this->other_tokens.capacity() +
+     this->depth_tokens.capacity()) * sizeof(field) +
+    (this->index.capacity() + this->extra_index.capacity() + this->partition.capacity()) * sizeof(int) +
+    this->generated.capacity();
+}
+
+
+
+//' Prepare insertion query
 //'
-//' @return selected field
-field* text_table::at(int row, int col){
-  return this->content->at(row)->at(col);
+//' selects the emitter of the given dialect (see echo_as)
+//'
+//' @param out the insertion statements of this table are appended here
+//' @param dialect POSTGRESQL, SQLITE or DUCKDB
+//' @param partition partition to be printed (-1 for the whole table)
+void text_table::echo(std::vector<std::string>& out, int dialect, int partition){
+  switch(dialect){
+  case SQLITE:
+    this->echo_as<sqlite_dialect>(out, partition);
+    break;
+  case DUCKDB:
+    this->echo_as<duckdb_dialect>(out, partition);
+    break;
+  default:
+    this->echo_as<postgres_dialect>(out, partition);
+  }
 }
 
 
 //' split in rows
 //'
-//' Create a new table based on a specific column
+//' Fill a table based on a specific column
 //' of this one. The separation occurs per field:
 //'
 //' col1  col2                               col1 col2
@@ -155,126 +151,74 @@ field* text_table::at(int row, int col){
 //' The resulting table is a Nx2 table (db_index, content).
 //'
 //' @param colname column to split
-//' @param name name of the content column
 //' @param sep separator
-//'
-//' @return new table
-text_table* text_table::separe_rows(std::string colname, std::string name, char sep){ // int rule
-  auto pos_it = std::find(this->header->begin(),
-                          this->header->end(), colname);
-  if(pos_it != this->header->end()){
-    int col = std::distance(this->header->begin(), pos_it);
-
-    auto new_header = new std::vector<std::string>();
-    new_header->push_back(colname);
-
-    auto new_rules = new std::vector<int>();
-    new_rules->push_back(1); // int rule
-
-    auto new_subtable = new text_table(
-      new_header,
-      new_rules,
-      name,
-      -1
-    );
+//' @param out output table (one column), it is not cleared
+void text_table::separe_rows(std::string colname, char sep, text_table& out){
+  auto pos_it = std::find(this->header.begin(),
+                          this->header.end(), colname);
+  if(pos_it != this->header.end()){
+    int col = std::distance(this->header.begin(), pos_it);
 
     // prepare table adding elements from the separation of each row
-    int new_row_pos = 0;
+    int new_row_pos = out.nrow();
     for(int i = 0; i<this->nrow(); i++){
       if(this->at(i,col)->length() == 0) continue;  /* skip null elements */
-      auto row = tokenize(this->at(i,col), sep);
-      for(auto el : *row){
-        new_subtable->add(el);
-        new_subtable->index.at(new_row_pos) = this->index.at(i);
+      tokenize(this->at(i,col), sep, this->tokens);
+      for(auto& el : this->tokens){
+        out.add(el);
+        out.index.at(new_row_pos) = this->index.at(i);
+        out.partition.at(new_row_pos) = this->partition.at(i);
         new_row_pos++;
       }
-      delete(row); // remember to delete pointer array
     }
 
-    return new_subtable;
-
   }else{
-    Rcerr << "Cannot separe_rows on column " << colname << ". Column not found.\n";
-    throw 1;
+    throw std::runtime_error("Cannot separe_rows on column " + colname + ". Column not found.");
   }
 }
 
 //' split in columns
 //'
-//' Create a new table based on a specific column of this one. The
+//' Fill a table based on a specific column of this one. The
 //' splitting is done by field:
 //'
 //' col1 col2        col1 col2 col3 col4
 //'   1 a;b;c  --->    1    a    b    c
 //'
+//' Key/value columns (a=3) are managed by an output table with a
+//' (key, value) header.
+//'
 //' @param colname name of the column to be splitted
-//'  @param new_header header of the new table
-//' @param new_rules rules for the new columns
-//' @param name name of the new table
 //' @param sep separator to be used
-//'
-//' @return the new table
-text_table* text_table::separe_cols(std::string colname, std::vector<std::string>* new_header, std::vector<int>* new_rules, std::string name, char sep){ // int rule
-  auto pos_it = std::find(this->header->begin(),
-                          this->header->end(), colname);
-  if(pos_it != this->header->end()){
-    int col = std::distance(this->header->begin(), pos_it);
-
-    auto new_subtable = new text_table(
-      new_header,
-      new_rules,
-      name,
-      -1
-    );
+//' @param out output table (its header defines the new columns), it is not cleared
+void text_table::separe_cols(std::string colname, char sep, text_table& out){
+  auto pos_it = std::find(this->header.begin(),
+                          this->header.end(), colname);
+  if(pos_it != this->header.end()){
+    int col = std::distance(this->header.begin(), pos_it);
 
     // prepare table adding elements from the separation of each row
-    int new_row_pos = 0;
+    int new_row_pos = out.nrow();
     for(int i = 0; i<this->nrow(); i++){
-      auto row = tokenize(this->at(i,col), sep);
-      for(auto el : *row){
-        new_subtable->add(el);
+      tokenize(this->at(i,col), sep, this->tokens);
+      for(auto& el : this->tokens){
+        out.add(el);
       }
-      new_subtable->index.at(i) = this->index.at(i);
-      delete(row); // remember to delete pointer array
+      out.index.at(new_row_pos) = this->index.at(i);
+      out.partition.at(new_row_pos) = this->partition.at(i);
+      new_row_pos++;
     }
 
-    return new_subtable;
-
   }else{
-    Rcerr << "Cannot separe_rows on column " << colname << ". Column not found.\n";
-    throw 1;
+    throw std::runtime_error("Cannot separe_rows on column " + colname + ". Column not found.");
   }
 }
 
-//' Split key/value column
-//'
-//' Creates a new table from a column where the field are interpreted as key value pairs
-//'
-//' col1 col2       col1 key value
-//'    1  a=3 --->     1   a     3
-//'
-//' @parma colname column name of the column to be splitted
-//' @param key_rule rule for the key
-//' @param value_rule rule for the value
-//' @param name name of the new table
-//' @param sep separator to be used
-//'
-//' @return the new table
-text_table* text_table::kv_separe(std::string colname, int key_rule, int value_rule, std::string name, char sep){
-  auto header_splitted_cols = new std::vector<std::string>();
-  header_splitted_cols->push_back("key");
-  header_splitted_cols->push_back("value");
-  auto rules_splitted_cols = new std::vector<int>();
-  rules_splitted_cols->push_back(key_rule);
-  rules_splitted_cols->push_back(value_rule);
-  return this->separe_cols(colname, header_splitted_cols, rules_splitted_cols, name, sep);
-}
-
 
 
 //' Merge key/value column
 //'
-//' Creates a new table from two column where the field are interpreted as key value pairs
+//' Fills a (key, value) table from two column where the field are interpreted as key value pairs
 //'
 //' col1 col2 col3       col1 key value
 //'    1  a;b  3:2  --->     1  a     3
@@ -282,66 +226,42 @@ text_table* text_table::kv_separe(std::string colname, int key_rule, int value_r
 //'
 //' @parma colname1 first column name of the column to be merged
 //' @parma colname1 first column name of the column to be merged
-//' @param key_rule rule for the key
-//' @param value_rule rule for the value
-//' @param name name of the new table
 //' @param sep1 separator to be used for the first column
 //' @param sep2 separator to be used for the second column
-//'
-//' @return the new table
-text_table* text_table::kv_merge(std::string colname1, std::string colname2, int key_rule, int value_rule, std::string name, char sep1, char sep2){
-  auto pos_it1 = std::find(this->header->begin(),
-                          this->header->end(), colname1);
-  auto pos_it2 = std::find(this->header->begin(),
-                          this->header->end(), colname2);
-  if((pos_it1 != this->header->end()) && (pos_it2 != this->header->end())){
-    int col1 = std::distance(this->header->begin(), pos_it1);
-    int col2 = std::distance(this->header->begin(), pos_it2);
-
-    auto new_header = new std::vector<std::string>();
-    new_header->push_back("key");
-    new_header->push_back("value");
-
-    auto new_rules = new std::vector<int>();
-    new_rules->push_back(key_rule);
-    new_rules->push_back(value_rule);
-
-    auto new_subtable = new text_table(
-      new_header,
-      new_rules,
-      name,
-      -1
-    );
+//' @param out output (key, value) table, it is not cleared
+void text_table::kv_merge(std::string colname1, std::string colname2, char sep1, char sep2, text_table& out){
+  auto pos_it1 = std::find(this->header.begin(),
+                          this->header.end(), colname1);
+  auto pos_it2 = std::find(this->header.begin(),
+                          this->header.end(), colname2);
+  if((pos_it1 != this->header.end()) && (pos_it2 != this->header.end())){
+    int col1 = std::distance(this->header.begin(), pos_it1);
+    int col2 = std::distance(this->header.begin(), pos_it2);
 
     // prepare table adding elements from the separation of each row
-    int new_row_pos = 0;
+    int new_row_pos = out.nrow();
     for(int i = 0; i<this->nrow(); i++){
 
-      auto row1 = tokenize(this->at(i,col1), sep1);
-      auto row2 = tokenize(this->at(i,col2), sep2);
+      tokenize(this->at(i,col1), sep1, this->tokens);
+      tokenize(this->at(i,col2), sep2, this->other_tokens);
 
-      for(int j=0; j<row1->size(); j++){
-        new_subtable->add(row1->at(j));
-        new_subtable->add(row2->at(j));
-        new_subtable->index.at(new_row_pos) = this->index.at(i);
+      for(int j=0; j<this->tokens.size(); j++){
+        out.add(this->tokens[j]);
+        out.add(this->other_tokens.at(j));
+        out.index.at(new_row_pos) = this->index.at(i);
+        out.partition.at(new_row_pos) = this->partition.at(i);
         new_row_pos++;
-
       }
-
-      delete(row1); // remember to delete pointer array
-      delete(row2); // remember to delete pointer array
     }
 
-    return new_subtable;
-
   }else{
-    Rcerr << "Cannot kv_merge on columns " << colname1 <<", "<< colname2<< ". A column was not found.\n";
-    throw 1;
+    throw std::runtime_error("Cannot kv_merge on columns " + colname1 + ", " + colname2 + ". A column was not found.");
   }
 }
 
 /* used to virutally add content for field pointers */
 std::string TRUE_STR = "true";
+std::string FALSE_STR = "false";
 
 
 //' Manage VCF info field in MAF files
@@ -353,121 +273,253 @@ std::string TRUE_STR = "true";
 //' fields are quoted and should be of varchar type.
 //'
 //' @param colname name of the INFO column
-//' @param key_rule (should be "quote")
-//' @param value_rule (should be "quote")
-//' @param name name of the new table
 //' @param sep separator to be used
-//'
-//' @return the newly created table
-text_table* text_table::separe_vcf_info_field(std::string colname, int key_rule, int value_rule, std::string name, char sep){
-
-  auto header_splitted_cols = new std::vector<std::string>();
-  header_splitted_cols->push_back("key");
-  header_splitted_cols->push_back("value");
-  auto rules_splitted_cols = new std::vector<int>();
-  rules_splitted_cols->push_back(key_rule);
-  rules_splitted_cols->push_back(value_rule);
-
-  auto pos_it = std::find(this->header->begin(),
-                          this->header->end(), colname);
-  if(pos_it != this->header->end()){
-    int col = std::distance(this->header->begin(), pos_it);
-
-    auto new_subtable = new text_table(
-      header_splitted_cols,
-      rules_splitted_cols,
-      name,
-      -1
-    );
+//' @param out output (key, value) table, it is not cleared
+void text_table::separe_vcf_info_field(std::string colname, char sep, text_table& out){
+  auto pos_it = std::find(this->header.begin(),
+                          this->header.end(), colname);
+  if(pos_it != this->header.end()){
+    int col = std::distance(this->header.begin(), pos_it);
 
     // prepare table adding elements from the separation of each row
-    int new_row_pos = 0;
+    int new_row_pos = out.nrow();
     for(int i = 0; i<this->nrow(); i++){
-      auto row = tokenize(this->at(i,col), sep);
-      for(auto el : *row){
-        new_subtable->add(el);
+      tokenize(this->at(i,col), sep, this->tokens);
+      for(auto& el : this->tokens){
+        out.add(el);
       }
-      if(row->size() == 1){ // is a flag, add true!
-        new_subtable->add(new field(0,4,&TRUE_STR));
+      if(this->tokens.size() == 1){ // is a flag, add true!
+        out.add(field(0,4,&TRUE_STR));
       }
-      new_subtable->index.at(i) = this->index.at(i);
-      delete(row); // remember to delete pointer array
+      out.index.at(new_row_pos) = this->index.at(i);
+      out.partition.at(new_row_pos) = this->partition.at(i);
+      new_row_pos++;
     }
 
-    return new_subtable;
-
   }else{
-    Rcerr << "Cannot separe_rows on column " << colname << ". Column not found.\n";
-    throw 1;
+    throw std::runtime_error("Cannot separe_rows on column " + colname + ". Column not found.");
   }
 }
 
 
 //' Manage "classification(score)" fields
 //'
-//' equal to key/value separation but removes brackets (inner function)
+//' equal to key/value separation but removes brackets
 //'
 //' @param colname name of the column of interest
-//' @param new_header header of the new table
-//' @param new_rules rules of the new table
-//' @param name name of the new table
-//'
-//' @return the newly created table
-text_table* text_table::separe_cols_brackets(std::string colname, std::vector<std::string>* new_header, std::vector<int>* new_rules, std::string name){ // int rule
-  auto pos_it = std::find(this->header->begin(),
-                          this->header->end(), colname);
-  if(pos_it != this->header->end()){
-    int col = std::distance(this->header->begin(), pos_it);
-
-    auto new_subtable = new text_table(
-      new_header,
-      new_rules,
-      name,
-      -1
-    );
+//' @param out output (classification, score) table, it is not cleared
+void text_table::separe_cols_brackets(std::string colname, text_table& out){
+  auto pos_it = std::find(this->header.begin(),
+                          this->header.end(), colname);
+  if(pos_it != this->header.end()){
+    int col = std::distance(this->header.begin(), pos_it);
 
     // prepare table adding elements from the separation of each row
-    int new_row_pos = 0; // do not keep null rows
+    int new_row_pos = out.nrow(); // do not keep null rows
     for(int i = 0; i<this->nrow(); i++){
-      auto row = tokenize_bracket(this->at(i,col));
+      tokenize_bracket(this->at(i,col), this->tokens);
 
-      if(row->size() == 0){
-        delete(row);
+      if(this->tokens.size() == 0){
         continue;
       }
-      for(auto el : *row){
-        new_subtable->add(el);
+      for(auto& el : this->tokens){
+        out.add(el);
       }
-      new_subtable->index.at(new_row_pos) = this->index.at(i);
+      out.index.at(new_row_pos) = this->index.at(i);
+      out.partition.at(new_row_pos) = this->partition.at(i);
       new_row_pos++;
-      delete(row); // remember to delete pointer array
     }
 
-    return new_subtable;
-
   }else{
-    Rcerr << "Cannot separe_rows on column " << colname << ". Column not found.\n";
-    throw 1;
+    throw std::runtime_error("Cannot separe_rows on column " + colname + ". Column not found.");
   }
 }
 
 
-//' Manage "classification(score)" fields
+
+
+//' Pivot a key/value list column in a wide table
 //'
-//' equal to key/value separation but removes brackets (outer function)
+//' Fills a table with a column for each of the given keys, the
+//' other keys are added to a key/value table:
 //'
-//' @param colname name of the column of interest
-//' @param name name of the new table
-//'
-//' @return the newly created table
-text_table* text_table::brackets_separe(std::string colname, std::string name){
-  auto header_splitted_cols = new std::vector<std::string>();
-  header_splitted_cols->push_back("classification");
-  header_splitted_cols->push_back("score");
-  auto rules_splitted_cols = new std::vector<int>();
-  rules_splitted_cols->push_back(1);
-  rules_splitted_cols->push_back(2);
-  return this->separe_cols_brackets(colname, header_splitted_cols, rules_splitted_cols, name);
+//' col1     col2                 col1  a  b          col1 key value
+//'    1 a=3;b;c=1 ---> pivot -->    1  3  true  +       1   c     1
+//'    2       a=4                   2  4  false
+//'
+//' Keys without a value are flags (boolean columns are false when the flag
+//' is missing). Values that do not match the type of their key are
+//' moved to the key/value table so that the query is always valid.
+//'
+//' @param colname name of the column to pivot
+//' @param key_types types of the keys (integer, bigint, float, boolean, varchar)
+//' @param sep separator of the key/value pairs
+//' @param kv_sep separator of key and value
+//' @param out output (wide) table, its header are the keys
+//' @param others (key, value) table for unknown keys and non matching values
+void text_table::pivot_kv(std::string colname, std::vector<std::string>& key_types, char sep, char kv_sep,
+                          text_table& out, text_table& others){
+  auto pos_it = std::find(this->header.begin(),
+                          this->header.end(), colname);
+  if(pos_it != this->header.end()){
+    int col = std::distance(this->header.begin(), pos_it);
+
+    std::unordered_map<std::string, int> key_position;
+    for(int k = 0; k<out.ncol(); k++){
+      key_position[out.header[k]] = k;
+    }
+
+    int new_row_pos = out.nrow();
+    int others_row_pos = others.nrow();
+    std::vector<field> cells(out.ncol(), field(0, 0, &FALSE_STR));
+    std::vector<bool> found(out.ncol());
+    for(int i = 0; i<this->nrow(); i++){
+      std::fill(found.begin(), found.end(), false);
+      if(this->at(i,col)->length() > 0){
+        tokenize(this->at(i,col), sep, this->tokens);
+        for(auto& el : this->tokens){
+          /* split key and value */
+          int eq = 0;
+          while(eq < el.length() && el.at(eq) != kv_sep) eq++;
+          field key = field(el.begin(), el.begin()+eq, el.source());
+          field value = (eq == el.length()) ?
+            field(0, TRUE_STR.size(), &TRUE_STR) : /* flag */
+            field(el.begin()+eq+1, el.end(), el.source());
+
+          auto hit = key_position.find(key.source()->substr(key.begin(), key.length()));
+          if(hit != key_position.end() && !found[hit->second] && conforms(&value, key_types.at(hit->second))){
+            cells[hit->second] = value;
+            found[hit->second] = true;
+          }else{
+            others.add(key);
+            others.add(value);
+            others.index.at(others_row_pos) = this->index.at(i);
+            others.partition.at(others_row_pos) = this->partition.at(i);
+            others_row_pos++;
+          }
+        }
+      }
+      for(int k = 0; k<out.ncol(); k++){
+        if(!found[k]){ /* missing key: false for flags, NULL otherwise */
+          cells[k] = key_types.at(k) == "boolean" ?
+            field(0, FALSE_STR.size(), &FALSE_STR) :
+            field(0, 0, &FALSE_STR);
+        }
+        out.add(cells[k]);
+      }
+      out.index.at(new_row_pos) = this->index.at(i);
+      out.partition.at(new_row_pos) = this->partition.at(i);
+      new_row_pos++;
+    }
+
+  }else{
+    throw std::runtime_error("Cannot pivot_kv on column " + colname + ". Column not found.");
+  }
 }
 
 
+//' Typed genotype of a sample
+//'
+//' Parses the FORMAT keys of a genotype column (e.g. vcf_tumor_gt) in a
+//' (role, gt, dp, ref_depth, alt_depth, vaf) row, the other keys are
+//' added to a key/value table (as kv_merge):
+//'
+//' vcf_format   vcf_tumor_gt            role  gt  dp ref alt  vaf         key value
+//' GT:AD:DP:XX  0/1:10,5:15:a  --->    tumor 0/1  15  10   5  0.333  +   XX     a
+//'
+//' AD is split in ref_depth (first allele) and alt_depth (sum of the other
+//' alleles), vaf is alt_depth/(ref_depth+alt_depth). Missing ("."), non
+//' numeric and out of range (int) values are NULL, rows with an empty genotype
+//' are skipped.
+//'
+//' @param format_colname name of the FORMAT column
+//' @param sample_colname name of the genotype column
+//' @param role role of the sample (tumor or normal)
+//' @param out output genotype table, it is not cleared
+//' @param others (key, value) table for the other keys
+void text_table::split_genotype(std::string format_colname, std::string sample_colname, std::string role,
+                                text_table& out, text_table& others){
+  auto pos_it1 = std::find(this->header.begin(),
+                          this->header.end(), format_colname);
+  auto pos_it2 = std::find(this->header.begin(),
+                          this->header.end(), sample_colname);
+  if((pos_it1 != this->header.end()) && (pos_it2 != this->header.end())){
+    int col1 = std::distance(this->header.begin(), pos_it1);
+    int col2 = std::distance(this->header.begin(), pos_it2);
+
+    /* computed fields are appended to the text of the output table */
+    auto generate = [&out](const std::string& text){
+      int start = out.generated.size();
+      out.generated.append(text);
+      return field(start, out.generated.size(), &out.generated);
+    };
+    auto depth = [](field& cell, long long& value){ // the columns are int
+      if(cell.length() == 0 || cell.length() > 10) return false;
+      value = 0;
+      for(int c = 0; c<cell.length(); c++){
+        if(cell.at(c) < '0' || cell.at(c) > '9') return false;
+        value = value*10 + (cell.at(c) - '0');
+      }
+      return value <= INT_MAX;
+    };
+    field null = field(0, 0, &FALSE_STR);
+
+    int new_row_pos = out.nrow();
+    int others_row_pos = others.nrow();
+    for(int i = 0; i<this->nrow(); i++){
+      if(this->at(i,col2)->length() == 0) continue;
+
+      tokenize(this->at(i,col1), ':', this->tokens);
+      tokenize(this->at(i,col2), ':', this->other_tokens);
+
+      field gt = null, dp = null, ref_depth = null, alt_depth = null, vaf = null;
+      for(int j=0; j<this->tokens.size() && j<this->other_tokens.size(); j++){
+        field& key = this->tokens[j];
+        field& value = this->other_tokens[j];
+        std::string name = key.source()->substr(key.begin(), key.length());
+        long long number;
+        if(name == "GT"){
+          if(!(value.length() == 1 && value.at(0) == '.')) gt = value;
+        }else if(name == "DP"){
+          if(depth(value, number)) dp = value;
+        }else if(name == "AD"){
+          tokenize(&value, ',', this->depth_tokens);
+          long long ref = 0, alt = 0;
+          bool valid = this->depth_tokens.size() > 1 && depth(this->depth_tokens[0], ref);
+          for(int a = 1; valid && a<this->depth_tokens.size(); a++){
+            valid = depth(this->depth_tokens[a], number) && alt + number <= INT_MAX;
+            if(valid) alt += number;
+          }
+          if(valid){
+            ref_depth = generate(std::to_string(ref));
+            alt_depth = generate(std::to_string(alt));
+            if(ref + alt > 0){
+              char buffer[32];
+              snprintf(buffer, sizeof(buffer), "%.6g", (double) alt / (ref + alt));
+              vaf = generate(buffer);
+            }
+          }
+        }else{
+          others.add(key);
+          others.add(value);
+          others.index.at(others_row_pos) = this->index.at(i);
+          others.partition.at(others_row_pos) = this->partition.at(i);
+          others_row_pos++;
+        }
+      }
+
+      out.add(generate(role));
+      out.add(gt);
+      out.add(dp);
+      out.add(ref_depth);
+      out.add(alt_depth);
+      out.add(vaf);
+      out.index.at(new_row_pos) = this->index.at(i);
+      out.partition.at(new_row_pos) = this->partition.at(i);
+      new_row_pos++;
+    }
+
+  }else{
+    throw std::runtime_error("Cannot split_genotype on columns " + format_colname + ", " + sample_colname + ". A column was not found.");
+  }
+}
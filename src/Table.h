@@ -5,38 +5,123 @@
  
 #include <Rcpp.h>
 #include <stdexcept>
+#include <unordered_map>
 #include "Field.h"
 #include "Utils.h"
 using namespace Rcpp;
  
+// a table of fields pointing to the original text.
+// Fields are stored by value in a flat (row major) vector, the table owns
+// its header and rules: clear() empties it keeping the allocated memory,
+// so that the same table can be reused for all the chunks of a file.
+// Rows can be assigned to partitions, that are printed separately.
+
 class text_table{
 public: 
-  text_table(std::vector<std::string>* header, std::vector<int>* rules, std::string name, int starting_point); 
-  int nrow(){return this->content->size();}
-  int ncol(){return this->header->size();}
+  text_table(std::vector<std::string> header, std::vector<int> rules, std::string name, int starting_point); 
+  int nrow(){return this->line + 1;}
+  int ncol(){return this->header.size();}
+  int column(std::string colname);
   int getDBindex(int i){return this->index[i] + 1 + this->starting_point;}
-  void add(field* next_field);
-  std::string echo();
-  ~text_table(); //TODO manage header and such...
-  field* at(int row, int col);
-  text_table* separe_rows(std::string colname, std::string name, char sep);
+  void add(field next_field);
+  void clear(int starting_point);
+  size_t allocated_bytes();
+  void echo(std::vector<std::string>& out, int dialect = POSTGRESQL, int partition = -1);
+  template<class dialect> void echo_as(std::vector<std::string>& out, int partition);
+  field* at(int row, int col){return &this->content[row*this->ncol() + col];}
+  void separe_rows(std::string colname, char sep, text_table& out);
   std::vector<int> index; 
   std::vector<int> extra_index;
+  std::vector<int> partition; // partition value of each row (see maf_loader)
+  const std::vector<int>* partition_buckets = NULL; // bucket of each partition value
+  const std::vector<std::string>* partition_keys = NULL; // if set, the value is printed as last column
   bool use_extra_index = false;
-  text_table* separe_cols(std::string colname, std::vector<std::string>* new_header, std::vector<int>* new_rules, std::string name, char sep);
-  text_table* kv_separe(std::string colname, int key_rule, int value_rule, std::string name, char sep);
-  text_table* kv_merge(std::string colname1, std::string colname2, int key_rule, int value_rule, std::string name, char sep1, char sep2);
-  text_table* separe_vcf_info_field(std::string colname, int key_rule, int value_rule, std::string name, char sep);
-  text_table* separe_cols_brackets(std::string colname, std::vector<std::string>* new_header, std::vector<int>* new_rules, std::string name);
-  text_table* brackets_separe(std::string colname, std::string name);
+  bool use_index = true; // false for tables without db_index (e.g. summaries)
+  void separe_cols(std::string colname, char sep, text_table& out);
+  void kv_merge(std::string colname1, std::string colname2, char sep1, char sep2, text_table& out);
+  void separe_vcf_info_field(std::string colname, char sep, text_table& out);
+  void separe_cols_brackets(std::string colname, text_table& out);
+  void pivot_kv(std::string colname, std::vector<std::string>& key_types, char sep, char kv_sep,
+                text_table& out, text_table& others);
+  void split_genotype(std::string format_colname, std::string sample_colname, std::string role,
+                      text_table& out, text_table& others);
 private: 
-  std::vector<std::vector<field*>*>* content;
-  std::vector<std::string>* header;
-  std::vector<int>* rules;
+  std::vector<field> content;
+  std::vector<std::string> header;
+  std::vector<int> rules;
+  std::vector<field> tokens, other_tokens, depth_tokens; // reused by the split functions
+  std::string generated; // text of computed fields (they point here by offset)
   std::string name;
   int line;
   int col;
   int starting_point;
 };
 
-#endif 
\ No newline at end of file
+
+
+//' Prepare insertion query
+//'
+//' db_index is the first column while the auxiliary index
+//' is the second column (when used).
+//'
+//' Quoting is managed field per field by the dialect, rows are split in
+//' more INSERT statements according to the dialect limits.
+//'
+//' @param out the statements are appended here (one string each)
+//' @param partition only rows of this bucket are printed, in the
+//' <name>_p<partition> table (-1 for all the rows, in <name>)
+template<class dialect>
+void text_table::echo_as(std::vector<std::string>& out, int partition){
+  std::string table_name = this->name;
+  if(partition >= 0){
+    table_name.append("_p" + std::to_string(partition));
+  }
+  table_name = dialect::identifier(table_name);
+  int statement_rows = 0;
+  for(int i = 0; i<this->nrow(); i++){
+    if(partition >= 0 && this->partition_buckets->at(this->partition.at(i)) != partition) continue; // another bucket
+    if(statement_rows == 0){ // new statement
+      out.emplace_back("INSERT INTO ");
+      out.back().append(table_name);
+      out.back().append(" VALUES \n");
+    }else{
+      out.back().push_back(',');
+    }
+    std::string& statement = out.back();
+    statement.push_back('(');
+    size_t row_start = statement.size();
+    if(this->use_index){
+      statement.append(std::to_string(this->index.at(i))); // add DB_INDEX
+    }
+    if(this->use_extra_index){
+      statement.push_back(',');
+      statement.append(std::to_string(this->extra_index.at(i))); // add EXTRA_INDEX
+    }
+    for(int j = 0; j<this->ncol(); j++){
+      if(this->rules[j] == 0) continue; // skip masked (rule 0) columns
+      if(statement.size() > row_start) statement.push_back(',');
+      this->at(i,j)->template echo<dialect>(statement);
+    }
+    if(this->partition_keys != NULL){ // partition value, so that the table can be filtered on it
+      const std::string& key = this->partition_keys->at(this->partition.at(i));
+      statement.push_back(',');
+      if(key.empty()){
+        statement.append("NULL");
+      }else{
+        dialect::quote(statement, key.data(), key.size());
+      }
+    }
+    statement.push_back(')');
+    statement_rows++;
+    if(statement_rows >= dialect::max_rows ||
+       statement.size() > dialect::max_statement_bytes){ // last line of the statement
+      statement.append(";\n");
+      statement_rows = 0;
+    }
+  }
+  if(statement_rows > 0){ // close the last statement
+    out.back().append(";\n");
+  }
+}
+
+#endif
@@ -8,17 +8,15 @@
 //'
 //' @param text a text field (create a text field for the first line)
 //' @param sep separator
-//'
-//' @return a list of the found sub-fields
-std::vector<field*>* tokenize(field* text, char sep){
+//' @param out the found sub-fields (cleared before tokenizing)
+void tokenize(field* text, char sep, std::vector<field>& out){
+  out.clear();
   int ini = 0;
   int cursor = 0;
-  std::vector<field*>* out_line = new std::vector<field*>();
   while(true){
     /* search separators and cut */
     if(cursor >= text->length() || text->at(cursor) == sep){
-      field* new_field = new field(text->begin()+ini, text->begin()+cursor, text->source());
-      out_line->push_back(new_field);
+      out.push_back(field(text->begin()+ini, text->begin()+cursor, text->source()));
       ini = cursor+1;
     }
     /* exit at field end */
@@ -27,7 +25,41 @@ std::vector<field*>* tokenize(field* text, char sep){
     }
     cursor++;
   }
-  return out_line;
+}
+
+
+
+//' tokenize a string keeping only some of its segments
+//'
+//' like tokenize, but fields are created only for segments whose
+//' rule is not 0 (masked), the scan stops after the last of them.
+//' Missing segments (short lines) are returned as empty fields.
+//'
+//' @param text a text field (create a text field for the first line)
+//' @param sep separator
+//' @param rules rule of each segment (0: skip)
+//' @param out the found sub-fields (cleared before tokenizing)
+void tokenize_selected(field* text, char sep, std::vector<int>* rules, std::vector<field>& out){
+  out.clear();
+  int last = rules->size() - 1;
+  while(last >= 0 && rules->at(last) == 0) last--;
+  int ini = 0;
+  int col = 0;
+  for(int cursor = 0; col <= last && cursor <= text->length(); cursor++){
+    /* search separators and cut */
+    if(cursor == text->length() || text->at(cursor) == sep){
+      if(rules->at(col) != 0){
+        out.push_back(field(text->begin()+ini, text->begin()+cursor, text->source()));
+      }
+      ini = cursor+1;
+      col++;
+    }
+  }
+  for(; col <= last; col++){ /* short line */
+    if(rules->at(col) != 0){
+      out.push_back(field(text->end(), text->end(), text->source()));
+    }
+  }
 }
 
 
@@ -65,11 +97,9 @@ bool locate_and_test(std::string column, int rule, std::vector<std::string>* col
 //' using a given separator to determine segments.
 //'
 //' @param text a text field (create a text field for the first line)
-//' @param sep separator
-//'
-//' @return a list of the found sub-fields
-std::vector<field*>* tokenize_bracket(field* text){
-  std::vector<field*>* out_line = new std::vector<field*>();
+//' @param out the found sub-fields, empty if there are no brackets
+void tokenize_bracket(field* text, std::vector<field>& out){
+  out.clear();
   int pos_open = -1;
   int pos_closed = -1;
   for(int i = 0; i<text->length(); i++){
@@ -87,9 +117,76 @@ std::vector<field*>* tokenize_bracket(field* text){
 
   /* HIT */
   if(pos_open != -1 && pos_closed != -1){
-    out_line->push_back(new  field(text->begin(), text->begin()+pos_open, text->source()));
-    out_line->push_back(new  field(text->begin()+pos_open+1, text->begin()+pos_closed, text->source()));
+    out.push_back(field(text->begin(), text->begin()+pos_open, text->source()));
+    out.push_back(field(text->begin()+pos_open+1, text->begin()+pos_closed, text->source()));
   }
+}
+
+
 
-  return out_line;
+//' test if a field can be stored in a column of a given type
+//'
+//' @param text the field
+//' @param type integer, bigint, float, boolean or varchar
+//'
+//' @return true if the field is a valid (unquoted) value of that type
+bool conforms(field* text, std::string type){
+  if(type == "varchar" || text->length() == 0){
+    return true;
+  }
+  std::string value = text->source()->substr(text->begin(), text->length());
+  if(type == "integer" || type == "bigint"){
+    int i = (value[0] == '-' || value[0] == '+') ? 1 : 0;
+    if(i == value.size()) return false;
+    for(; i<value.size(); i++){
+      if(value[i] < '0' || value[i] > '9') return false;
+    }
+    /* the value must also fit the column (int is 32 bits, bigint 64) */
+    errno = 0;
+    long long number = std::strtoll(value.c_str(), NULL, 10);
+    if(errno == ERANGE) return false;
+    return type == "bigint" || (number >= INT_MIN && number <= INT_MAX);
+  }
+  if(type == "float"){
+    char* end;
+    std::strtod(value.c_str(), &end);
+    return *end == '\0' && value.find_first_of("nNiIxX") == std::string::npos; // no nan, inf or hex
+  }
+  if(type == "boolean"){
+    std::transform(value.begin(), value.end(), value.begin(), ::tolower);
+    return value == "true" || value == "false";
+  }
+  return false;
+}
+
+
+
+//' Partition (bucket) of a value of the partition column
+//'
+//' 64 bit FNV-1a hash of the value modulo the number of buckets, it does not
+//' depend on the platform, so that the buckets are the same in every load
+//'
+//' @param value value of the partition column ("" for NULL)
+//' @param buckets number of partitions
+//'
+//' @return the partition, from 0 to buckets-1
+int partition_bucket(const std::string& value, int buckets){
+  unsigned long long hash = 14695981039346656037ULL;
+  for(unsigned char c : value){
+    hash ^= c;
+    hash *= 1099511628211ULL;
+  }
+  return hash % buckets;
+}
+
+
+//' SQL dialect from its name
+//'
+//' @param name postgresql, sqlite or duckdb
+//'
+//' @return the dialect constant (see Dialect.h)
+int dialect_from_name(std::string name){
+  if(name == "sqlite") return SQLITE;
+  if(name == "duckdb") return DUCKDB;
+  return POSTGRESQL;
 }
@@ -2,11 +2,16 @@
 #define MAF_READER_UTILS
 
 #include <Rcpp.h>
+#include <cerrno>
+#include <climits>
 #include "Table.h" 
 using namespace Rcpp;
 
-std::vector<field*>* tokenize(field* text, char sep);
-std::vector<field*>* tokenize_bracket(field* text);
+void tokenize(field* text, char sep, std::vector<field>& out);
+void tokenize_selected(field* text, char sep, std::vector<int>* rules, std::vector<field>& out);
+void tokenize_bracket(field* text, std::vector<field>& out);
+bool conforms(field* text, std::string type);
+int partition_bucket(const std::string& value, int buckets);
 bool locate_and_test(std::string column, int rule, std::vector<std::string>* columns, std::vector<int>* rules);
 
 #endif  
\ No newline at end of file